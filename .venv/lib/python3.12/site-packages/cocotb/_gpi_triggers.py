@@ -8,6 +8,7 @@
 
 from __future__ import annotations
 
+import os
 import sys
 import warnings
 from collections.abc import Generator
@@ -237,10 +238,19 @@ class NextTimeStep(GPITrigger):
 _SignalType = TypeVar("_SignalType", bound="cocotb.handle.ValueObjectBase[Any, Any]")
 
 
+# Keep edge callbacks registered in the simulator between firings
+_persistent_edges = bool(int(os.environ.get("COCOTB_PERSISTENT_EDGE_TRIGGERS", "0")))
+
+
 class _EdgeBase(GPITrigger, Generic[_SignalType]):
     """Internal base class that fires on a given edge of a signal."""
 
     _edge_type: ClassVar[int]
+    # Register a persistent value change callback, which stays armed for as long
+    # as something awaits the edge again each time it fires, rather than a new
+    # one-shot callback every time
+    _persistent: ClassVar[bool] = _persistent_edges
+    _is_persistent: bool
     signal: _SignalType
 
     @classmethod
@@ -254,12 +264,35 @@ class _EdgeBase(GPITrigger, Generic[_SignalType]):
         pass
 
     def _prime(self) -> None:
-        self._cbhdl = simulator.register_value_change_callback(
-            self.signal._handle, self._react, type(self)._edge_type
-        )
+        if self._cbhdl is not None:
+            # The persistent callback is still armed from the last firing
+            return
+        if _EdgeBase._persistent:
+            self._cbhdl = simulator.register_persistent_value_change_callback(
+                self.signal._handle, self._react, type(self)._edge_type
+            )
+            if self._cbhdl is None:
+                # Not supported by this simulator, so stop trying
+                _EdgeBase._persistent = False
+        self._is_persistent = self._cbhdl is not None
+        if self._cbhdl is None:
+            self._cbhdl = simulator.register_value_change_callback(
+                self.signal._handle, self._react, type(self)._edge_type
+            )
         if self._cbhdl is None:
             raise RuntimeError(f"Unable set up {self} Trigger")
 
+    def _react(self) -> None:
+        if not self._is_persistent:
+            # The one-shot callback is gone once it fires
+            self._cbhdl = None
+            super()._react()
+            return
+        super()._react()
+        # Nothing awaited the edge again, so stop the simulator calling back
+        if not self._callbacks and self._cbhdl is not None:
+            self._unprime()
+
     def __repr__(self) -> str:
         return f"{type(self).__qualname__}({self.signal!r})"
 
@@ -0,0 +1,60 @@
+# Copyright cocotb contributors
+# Licensed under the Revised BSD License, see LICENSE for details.
+# SPDX-License-Identifier: BSD-3-Clause
+
+"""Forking a running simulation from a checkpoint."""
+
+from __future__ import annotations
+
+import cocotb
+from cocotb import simulator
+from cocotb._gpi_triggers import NextTimeStep
+
+__all__ = ("fork_simulation",)
+
+
+async def fork_simulation(children: int) -> int:
+    r"""Fork the simulation into *children* copies of itself at the end of the current time step.
+
+    Each child carries on from the same design and testbench state
+    with a different random seed, and finishes only the current test.
+    The parent waits for all of them, merges their results into its own results file,
+    and then carries on with the rest of the regression.
+
+    This lets many runs share one elaborated, reset design:
+
+    .. code-block:: python
+
+        @cocotb.test()
+        async def random_traffic(dut):
+            await reset(dut)
+            if await fork_simulation(os.cpu_count()) == 0:
+                return  # the children ran the traffic
+            await run_random_traffic(dut)
+
+    Children write their waveforms, coverage, and results to files named like ``dump.fork1.vcd``.
+    Only the Verilator harness supports checkpoints, and only for single-threaded models.
+
+    Args:
+        children: The number of child simulations to fork.
+
+    Returns:
+        ``0`` in the parent, after all the children have finished,
+        or the index of the child, from ``1`` to *children*.
+
+    Raises:
+        RuntimeError: If the simulator does not support checkpoints,
+            could not fork every child, or a child crashed or exited with an error.
+    """
+    simulator.request_checkpoint(children)
+    await NextTimeStep()
+
+    index = simulator.get_checkpoint_index()
+    if index > 0:
+        cocotb._regression_manager._forked(index)
+        return index
+
+    cocotb._regression_manager._join_forks(children)
+    if index < 0:
+        raise RuntimeError("Failed to fork or finish every child simulation")
+    return 0
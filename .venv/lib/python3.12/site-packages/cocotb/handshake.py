@@ -0,0 +1,105 @@
+# Copyright cocotb contributors
+# Licensed under the Revised BSD License, see LICENSE for details.
+# SPDX-License-Identifier: BSD-3-Clause
+
+"""A native valid/ready channel monitor."""
+
+from __future__ import annotations
+
+import logging
+from collections.abc import Sequence
+from typing import Any
+
+from cocotb.handle import LogicObject, ValueObjectBase
+from cocotb.simulator import monitor_create
+
+__all__ = ("HandshakeMonitor",)
+
+
+class HandshakeMonitor:
+    r"""Check a valid/ready channel and collect its statistics without waking Python every clock.
+
+    The checks run in C++ on each rising edge of *clock*,
+    against the values settled at the end of the time step before the edge.
+    Python is only called when a rule is broken:
+
+    * once valid is high, it stays high with the same data until ready is,
+    * everything accepted upstream is delivered downstream once, in order.
+
+    .. code-block:: python
+
+        monitor = HandshakeMonitor(
+            dut.clk,
+            upstream=(dut.valid_in, dut.ready_in, dut.data_in),
+            downstream=(dut.valid_out, dut.ready_out, dut.data_out),
+        )
+        monitor.start()
+        await run_traffic(dut)
+        monitor.stop()
+        monitor.check()
+        dut._log.info("throughput %.2f", monitor.throughput)
+
+    Args:
+        clock: The clock of the channel.
+        upstream: The ``(valid, ready, data)`` signals going into the design.
+        downstream: The ``(valid, ready, data)`` signals coming out of it.
+
+    Each signal must be a ``logic`` or integer object.
+    Data of any width is compared in full, X and Z bits included.
+    """
+
+    def __init__(
+        self,
+        clock: LogicObject,
+        upstream: Sequence[ValueObjectBase[Any, Any]],
+        downstream: Sequence[ValueObjectBase[Any, Any]],
+    ) -> None:
+        self._monitor = monitor_create(
+            clock._handle,
+            [s._handle for s in upstream],
+            [s._handle for s in downstream],
+        )
+        self._log = logging.getLogger(f"cocotb.{clock._name}.monitor")
+        self.violations: list[str] = []
+        """Messages for the protocol violations seen since the last :meth:`start`."""
+
+    def start(self) -> None:
+        """Clear the statistics and start checking from the next clock edge."""
+        self.violations.clear()
+        self._monitor.start(self._on_violation)
+
+    def stop(self) -> None:
+        """Stop checking, keeping the statistics."""
+        self._monitor.stop()
+
+    def _on_violation(self, message: str) -> None:
+        self._log.error("%s", message)
+        self.violations.append(message)
+
+    def stats(self) -> dict[str, Any]:
+        """The statistics since the last :meth:`start`.
+
+        Counts of ``cycles`` (clock edges), ``violations``, beats ``in_flight``,
+        and beats, stalls (valid without ready) and idle edges (ready without valid)
+        for each side, such as ``upstream_stalls``.
+        ``occupancy`` counts edges by the beats in flight after them,
+        and ``latency`` counts beats by the edges they took from upstream to downstream.
+        """
+        return self._monitor.stats()
+
+    @property
+    def throughput(self) -> float:
+        """Beats delivered downstream per clock edge."""
+        stats = self._monitor.stats()
+        return stats["downstream_beats"] / stats["cycles"] if stats["cycles"] else 0.0
+
+    def check(self) -> None:
+        """Fail if any protocol violation was seen since the last :meth:`start`.
+
+        Raises:
+            AssertionError: With the first violation.
+        """
+        if self.violations:
+            raise AssertionError(
+                f"{len(self.violations)} valid/ready violation(s), first: {self.violations[0]}"
+            )
@@ -0,0 +1,135 @@
+# Copyright cocotb contributors
+# Licensed under the Revised BSD License, see LICENSE for details.
+# SPDX-License-Identifier: BSD-3-Clause
+
+"""A native stimulus player."""
+
+from __future__ import annotations
+
+from collections.abc import Sequence
+from typing import Any
+
+from cocotb._gpi_triggers import GPITrigger
+from cocotb._utils import pointer_str
+from cocotb.handle import (
+    Deposit,
+    Force,
+    Immediate,
+    LogicObject,
+    ValueObjectBase,
+    _GPISetAction,
+)
+from cocotb.simulator import GpiPlayer, player_create
+
+__all__ = ("StimulusPlayer",)
+
+
+class _PlayerDone(GPITrigger):
+    """Fires when a :class:`~cocotb.simulator.GpiPlayer` runs out of stimulus or its watch hits."""
+
+    def __init__(self, player: GpiPlayer, set_action: int) -> None:
+        super().__init__()
+        self._player = player
+        self._set_action = set_action
+
+    def _prime(self) -> None:
+        self._player.start(self._set_action, self._react)
+
+    def _unprime(self) -> None:
+        self._player.stop()
+
+    def __repr__(self) -> str:
+        return f"<{type(self).__qualname__} at {pointer_str(self)}>"
+
+
+class StimulusPlayer:
+    r"""Drive per-cycle stimulus and sample responses without waking Python every clock.
+
+    The stimulus is applied from C++ on each rising edge of *clock*,
+    so a whole block of cycles costs a single Python wakeup.
+
+    .. code-block:: python
+
+        player = StimulusPlayer(
+            dut.clk,
+            drive=[dut.valid_in, dut.data_in, dut.ready_out],
+            capture=[dut.valid_out, dut.data_out, dut.ready_in],
+        )
+        player.load(numpy.array(rows, dtype=numpy.uint32))
+        await player.play()
+        out = numpy.frombuffer(player.captured, dtype=numpy.uint32).reshape(-1, 3)
+
+    Args:
+        clock: The clock whose rising edges pace the stimulus.
+        drive: Signals written with one row of stimulus per cycle.
+        capture: Signals sampled after each rising edge.
+        set_action:
+            One of :class:`.Immediate`, :class:`.Deposit`, or :class:`.Force`.
+            The action used to write the *drive* signals.
+
+    Each *drive* and *capture* signal must be a ``logic`` or integer object of at most 32 bits.
+    """
+
+    def __init__(
+        self,
+        clock: LogicObject,
+        drive: Sequence[ValueObjectBase[Any, Any]],
+        capture: Sequence[ValueObjectBase[Any, Any]] = (),
+        *,
+        set_action: type[Immediate] | type[Deposit] | type[Force] = Deposit,
+    ) -> None:
+        if set_action not in (Immediate, Deposit, Force):
+            raise TypeError(
+                "Invalid value for `set_action`. `set_action` must be one of Immediate, Deposit, or Force"
+            )
+        self._capture = list(capture)
+        self._set_action = {
+            Deposit: _GPISetAction.DEPOSIT,
+            Immediate: _GPISetAction.NO_DELAY,
+            Force: _GPISetAction.FORCE,
+        }[set_action].value
+        self._player = player_create(
+            clock._handle,
+            [s._handle for s in drive],
+            [s._handle for s in self._capture],
+        )
+
+    def load(self, stimulus: Any) -> None:
+        """Load the stimulus to play.
+
+        Args:
+            stimulus:
+                A buffer of native-endian 32-bit words, one per *drive* signal per cycle, cycle-major,
+                such as a ``numpy.uint32`` array of shape ``(cycles, len(drive))``.
+        """
+        self._player.load(stimulus)
+
+    def watch(
+        self, signal: ValueObjectBase[Any, Any], value: int, mask: int = 0xFFFFFFFF
+    ) -> None:
+        """Stop playing early once ``signal & mask == value`` after a clock edge.
+
+        Args:
+            signal: One of the *capture* signals.
+            value: The value to wait for.
+            mask: The bits of *signal* to compare.
+        """
+        self._player.watch(self._capture.index(signal), mask, value)
+
+    def clear_watch(self) -> None:
+        """Play the whole stimulus regardless of the captured values."""
+        self._player.watch(-1, 0, 0)
+
+    async def play(self) -> int:
+        """Play the loaded stimulus.
+
+        Returns:
+            The number of cycles played.
+        """
+        await _PlayerDone(self._player, self._set_action)
+        return self._player.cycles()
+
+    @property
+    def captured(self) -> bytes:
+        """The values sampled by the last :meth:`play`, one 32-bit word per *capture* signal per cycle."""
+        return self._player.captured()
@@ -17,6 +17,7 @@ import random
 import re
 import time
 import warnings
+import xml.etree.ElementTree as ET
 from collections.abc import Coroutine
 from enum import auto
 from importlib import import_module
@@ -761,6 +762,80 @@ class RegressionManager:
             )
         )
 
+    def _forked(self, index: int) -> None:
+        """Called in a child simulation forked by :func:`cocotb.checkpoint.fork_simulation`.
+
+        The child finishes only the current test, with its own random seed,
+        and reports it to its own results file for the parent to merge in :meth:`_join_forks`.
+        """
+        self._test_queue.clear()
+        self._included.clear()
+        self._test_results.clear()
+        self.total_tests = 1
+        self.count = self.passed = self.skipped = self.failures = 0
+
+        cocotb.RANDOM_SEED += index
+        random.seed(cocotb.RANDOM_SEED)
+
+        suite = self.xunit.last_testsuite.attrib
+        root, ext = os.path.splitext(self.xunit.filename)
+        self.xunit = XUnitReporter(filename=f"{root}.fork{index}{ext}")
+        self.xunit.add_testsuite(**suite)
+        self.xunit.add_property(name="random_seed", value=str(cocotb.RANDOM_SEED))
+        self.xunit.add_property(name="fork", value=str(index))
+
+    def _join_forks(self, n_children: int) -> None:
+        """Merge the results of the *n_children* simulations forked from the current test."""
+        root, ext = os.path.splitext(self.xunit.filename)
+        for index in range(1, n_children + 1):
+            filename = f"{root}.fork{index}{ext}"
+            try:
+                results = ET.parse(filename).getroot()
+            except (OSError, ET.ParseError):
+                self.log.error(
+                    "Forked simulation %d left no results in %s", index, filename
+                )
+                self.xunit.add_testcase(
+                    name=f"{self._test.name}[fork{index}]",
+                    classname=self._test.module,
+                    time="0",
+                    sim_time_ns="0",
+                    ratio_time="0",
+                )
+                self.xunit.add_failure(msg="Forked simulation left no results")
+                self.failures += 1
+                self.count += 1
+                self.total_tests += 1
+                self._test_results.append(
+                    _TestResults(
+                        test_fullname=f"{self._test.fullname}[fork{index}]",
+                        passed=False,
+                        sim_time_ns=0,
+                        wall_time_s=0,
+                    )
+                )
+                continue
+            os.remove(filename)
+
+            for testcase in results.iter("testcase"):
+                testcase.set("name", f"{testcase.get('name')}[fork{index}]")
+                self.xunit.last_testsuite.append(testcase)
+                passed = testcase.find("failure") is None
+                if passed:
+                    self.passed += 1
+                else:
+                    self.failures += 1
+                self.count += 1
+                self.total_tests += 1
+                self._test_results.append(
+                    _TestResults(
+                        test_fullname=f"{testcase.get('classname')}.{testcase.get('name')}",
+                        passed=passed,
+                        sim_time_ns=float(testcase.get("sim_time_ns", 0)),
+                        wall_time_s=float(testcase.get("time", 0)),
+                    )
+                )
+
     def _log_test_summary(self) -> None:
         """Called by :meth:`_tear_down` to log the test summary."""
         real_time = time.time() - self._regression_start_time
@@ -182,6 +182,94 @@ GPI_EXPORT const char *gpi_get_simulator_product(void);
  */
 GPI_EXPORT const char *gpi_get_simulator_version(void);
 
+/** Fork the simulation at the end of the current time step.
+ *
+ * The simulator forks @p n_children copies of itself once the current time
+ * step is over, then waits for all of them to finish before carrying on, so
+ * every child starts from the same state. Only simulators which enable
+ * checkpoints (currently the Verilator harness) support this.
+ *
+ * @param n_children  Number of children to fork.
+ * @return `0` if the request was accepted, `-1` otherwise.
+ */
+GPI_EXPORT int gpi_request_checkpoint(int n_children);
+
+/** Get the index of this process among those forked at the last checkpoint.
+ *
+ * @return `0` in the original process, `1` to `n_children` in the children,
+ *         or `-1` if the last checkpoint failed to fork every child or a
+ *         child did not exit cleanly.
+ */
+GPI_EXPORT int gpi_get_checkpoint_index(void);
+
+/** Only trace the time steps in [@p start, @p stop).
+ *
+ * Trace control is only supported by simulators which enable it (currently
+ * the Verilator harness, when it is tracing).
+ *
+ * @param start  First time step to trace, in simulator steps.
+ * @param stop   Time step to stop tracing at, in simulator steps.
+ * @return `0` on success, `-1` otherwise.
+ */
+GPI_EXPORT int gpi_trace_set_window(uint64_t start, uint64_t stop);
+
+/** Only trace the time steps at the end of which every signal has its value.
+ *
+ * For example `valid_out == 1 && ready_out == 0` to trace backpressure.
+ *
+ * @param n_terms  Number of signals, or `0` to trace regardless of signals.
+ * @param sig_hdls Signals to check.
+ * @param values   Value each signal must have.
+ * @return `0` on success, `-1` otherwise.
+ */
+GPI_EXPORT int gpi_trace_set_trigger(int n_terms, const gpi_sim_hdl *sig_hdls,
+                                     const long *values);
+
+/** Keep the trace in memory, holding at least the last @p steps traced time
+ * steps, until it is saved with gpi_trace_save_ring().
+ *
+ * The time steps are held in two segments of up to @p steps each, the older
+ * dropped when the newer is full, so up to `2 * steps` are held.
+ *
+ * A @p steps of `0` turns the ring off again: the trace goes back to the
+ * trace file, and time steps held but not saved are dropped.
+ *
+ * @param steps  Number of traced time steps to keep, or `0`.
+ * @return `0` on success, `-1` otherwise.
+ */
+GPI_EXPORT int gpi_trace_set_ring(int steps);
+
+/** Write the trace ring out to a file at the end of the current time step.
+ *
+ * @return `0` if the request was accepted, `-1` if there is no trace ring.
+ */
+GPI_EXPORT int gpi_trace_save_ring(void);
+
+/** Get the profile counter called @p name, creating it at zero.
+ *
+ * Profiling is enabled by setting the `GPI_PROFILE` environment variable.
+ * Counters ending in `.ticks` count time in the units of
+ * gpi_get_profile_tick_rate(); the rest count events.
+ *
+ * @param name  Name of the counter, like `harness.eval.ticks`.
+ * @return Where to add to the counter, which stays valid for the rest of the
+ *         simulation, or `NULL` if profiling is disabled.
+ */
+GPI_EXPORT uint64_t *gpi_profile_counter(const char *name);
+
+/** Get a profile counter by its index, in the order they were created.
+ *
+ * @param index  Index of the counter.
+ * @param name   Where to return the name of the counter.
+ * @param value  Where to return the value of the counter.
+ * @return `0` on success, `-1` if there is no such counter.
+ */
+GPI_EXPORT int gpi_get_profile_counter(int index, const char **name,
+                                       uint64_t *value);
+
+/** @return The number of profile ticks per second. */
+GPI_EXPORT double gpi_get_profile_tick_rate(void);
+
 /** @} */  // End of group SimIntf
 
 /** @defgroup ObjQuery Simulation Object Query
@@ -218,6 +306,20 @@ GPI_EXPORT gpi_sim_hdl gpi_get_handle_by_name(gpi_sim_hdl parent,
 GPI_EXPORT gpi_sim_hdl gpi_get_handle_by_index(gpi_sim_hdl parent,
                                                int32_t index);
 
+/** Discover every object below a scope in a single walk of the hierarchy.
+ *
+ * The objects found are indexed under their parents, so later
+ * @ref gpi_get_handle_by_name lookups of them, and
+ * @ref gpi_get_handle_by_index lookups of generate array elements, don't go
+ * to the simulator.
+ *
+ * @param base   Handle to the scope to walk.
+ * @param depth  Number of levels of nested scopes to walk into,
+ *               or `-1` to walk the whole hierarchy below @p base.
+ * @return The number of objects discovered.
+ */
+GPI_EXPORT int gpi_discover_scope(gpi_sim_hdl base, int depth);
+
 /** @} */  // End of group ObjQuery
 
 /** @defgroup ObjProps General Object Properties
@@ -294,6 +396,23 @@ GPI_EXPORT double gpi_get_signal_value_real(gpi_sim_hdl gpi_hdl);
  */
 GPI_EXPORT long gpi_get_signal_value_long(gpi_sim_hdl gpi_hdl);
 
+/** Get signal object value as packed 4-state words.
+ *
+ * The value is written as pairs of 32-bit words (`aval`, `bval`), least
+ * significant pair first, with the same encoding as `s_vpi_vecval`:
+ * `aval`/`bval` bits of `0`/`0` are `0`, `1`/`0` are `1`, `1`/`1` are `X` and
+ * `0`/`1` are `Z`. No memory is allocated.
+ *
+ * @param gpi_hdl   Signal object handle.
+ * @param words     Caller-provided buffer of `2 * n_pairs` words.
+ * @param n_pairs   Number of (`aval`, `bval`) pairs that fit in *words*.
+ * @return          Number of pairs needed to hold the whole value, or `-1` if
+ *                  the value can't be read this way. If larger than *n_pairs*,
+ *                  only the *n_pairs* least significant pairs were written.
+ */
+GPI_EXPORT int gpi_get_signal_value_vector(gpi_sim_hdl gpi_hdl, uint32_t *words,
+                                           int n_pairs);
+
 /** Get signal object name.
  * @param gpi_hdl   Signal object handle.
  * @return          Object name.
@@ -334,6 +453,19 @@ GPI_EXPORT void gpi_set_signal_value_binstr(gpi_sim_hdl gpi_hdl,
                                             const char *str,
                                             gpi_set_action action);
 
+/** Set signal object value with packed 4-state words.
+ * @param gpi_hdl   Signal object handle.
+ * @param words     Pairs of (`aval`, `bval`) words, least significant pair
+ *                  first, encoded as for @ref gpi_get_signal_value_vector.
+ * @param n_pairs   Number of pairs in *words*. Must cover the whole object.
+ * @param action    Action to use.
+ * @return          `0` on success, `-1` if *n_pairs* is too small or the value
+ *                  can't be set this way.
+ */
+GPI_EXPORT int gpi_set_signal_value_vector(gpi_sim_hdl gpi_hdl,
+                                           const uint32_t *words, int n_pairs,
+                                           gpi_set_action action);
+
 /** Set signal object value with a byte array.
  * @param gpi_hdl   Signal object handle.
  * @param str       Object value. Null-terminated byte array.
@@ -399,6 +531,25 @@ GPI_EXPORT gpi_cb_hdl gpi_register_value_change_callback(
     int (*gpi_function)(void *), void *gpi_cb_data, gpi_sim_hdl gpi_hdl,
     gpi_edge edge);
 
+/** Register a value change callback which stays armed after it fires.
+ *
+ * Unlike @ref gpi_register_value_change_callback, @p gpi_function is called
+ * on every matching change until the callback is removed with
+ * @ref gpi_remove_cb. This saves registering a new callback on every edge of a
+ * signal that is waited on over and over, like a clock.
+ *
+ * @param gpi_function  Callback function pointer.
+ * @param gpi_cb_data   Pointer to user data to be passed to callback function.
+ *                      It must stay valid until the callback is removed.
+ * @param gpi_hdl       Simulation object to monitor for value change.
+ * @param edge          Type of value change to monitor for.
+ * @return              Handle to callback object, or `NULL` if the
+ *                      implementation doesn't support persistent callbacks.
+ */
+GPI_EXPORT gpi_cb_hdl gpi_register_persistent_value_change_callback(
+    int (*gpi_function)(void *), void *gpi_cb_data, gpi_sim_hdl gpi_hdl,
+    gpi_edge edge);
+
 /** Register a readonly simulation phase callback.
  *
  * Callback will be called when simulation next enters the readonly phase.
@@ -58,17 +58,36 @@ enum gpi_log_level {
                        ///< shutdown.
 };
 
+/** Lowest log level compiled into the logging macros.
+ *
+ * Messages logged through the macros below this level are dropped at compile
+ * time, along with the evaluation of their arguments, e.g. build with
+ * `-DGPI_LOG_MIN_LEVEL=20` to leave out all TRACE and DEBUG messages.
+ */
+#ifndef GPI_LOG_MIN_LEVEL
+#define GPI_LOG_MIN_LEVEL 0
+#endif
+
 /** Logs a message at a given log level using the current log handler.
  * The caller provides explicit location information.
  */
-#define LOG_EXPLICIT(logger, level, file, func, lineno, ...) \
-    gpi_log_(logger, level, file, func, lineno, __VA_ARGS__)
+#define LOG_EXPLICIT(logger, level, file, func, lineno, ...)          \
+    do {                                                              \
+        if ((level) >= GPI_LOG_MIN_LEVEL) {                           \
+            gpi_log_(logger, level, file, func, lineno, __VA_ARGS__); \
+        }                                                             \
+    } while (0)
 
 /** Logs a message at a given log level using the current log handler.
  * Automatically populates arguments using information in the called context.
  */
-#define LOG_(level, ...) \
-    gpi_log_("gpi", level, __FILE__, __func__, __LINE__, __VA_ARGS__)
+#define LOG_(level, ...)                                         \
+    do {                                                         \
+        if ((level) >= GPI_LOG_MIN_LEVEL) {                      \
+            gpi_log_("gpi", level, __FILE__, __func__, __LINE__, \
+                     __VA_ARGS__);                               \
+        }                                                        \
+    } while (0)
 
 /** Logs a message at TRACE log level using the current log handler.
  * Only logs if GPI debug is enabled.
@@ -241,6 +260,33 @@ GPI_EXPORT void gpi_set_log_handler(gpi_log_handler_ftype handler,
 /** Clear the current custom log handler and use native logger. */
 GPI_EXPORT void gpi_clear_log_handler(void);
 
+/** Queue messages below WARNING and write them from a background thread.
+ *
+ * The format string is queued with a copy of its arguments, and formatted and
+ * written by the native logger off the simulation thread, at its log level.
+ * WARNING and above are still sent to the current log handler when logged,
+ * after everything queued before them is written.
+ * The *name*, *pathname*, *funcname* and *msg* of queued messages must stay
+ * valid until the end of the simulation, as the string literals used by the
+ * logging macros do.
+ * Also enabled by setting the `GPI_LOG_ASYNC` environment variable.
+ */
+GPI_EXPORT void gpi_log_async_enable(void);
+
+/** Wait until every queued message has been written. */
+GPI_EXPORT void gpi_log_flush(void);
+
+/** Write every queued message and stop the background thread, e.g. so that
+ * no thread holds a lock across a fork. Messages logged while paused are
+ * written at once.
+ */
+GPI_EXPORT void gpi_log_async_pause(void);
+
+/** Restart the background thread after gpi_log_async_pause(), in the original
+ * process or a forked child.
+ */
+GPI_EXPORT void gpi_log_async_resume(void);
+
 /*******************************************************************************
  * GPI Native Logger
  *******************************************************************************/
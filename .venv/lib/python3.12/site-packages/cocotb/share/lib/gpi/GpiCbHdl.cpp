@@ -4,6 +4,7 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
 #include <gpi.h>
+#include <gpi_logging.h>
 
 #include "./gpi_priv.hpp"
 
@@ -54,3 +55,16 @@ int GpiObjHdl::initialise(const std::string &name, const std::string &fq_name) {
     m_fullname = fq_name;
     return 0;
 }
+
+int GpiSignalObjHdl::get_signal_value_vector(uint32_t *, int) {
+    LOG_ERROR("%s does not support getting %s as packed words",
+              m_impl->get_name_c(), get_name_str());
+    return -1;
+}
+
+int GpiSignalObjHdl::set_signal_value_vector(const uint32_t *, int,
+                                             gpi_set_action) {
+    LOG_ERROR("%s does not support setting %s from packed words",
+              m_impl->get_name_c(), get_name_str());
+    return -1;
+}
@@ -9,8 +9,15 @@
 #include <sys/types.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -27,15 +34,13 @@ static vector<std::pair<void (*)(void *), void *>> finalize_cbs;
 class GpiHandleStore {
   public:
     GpiObjHdl *check_and_store(GpiObjHdl *hdl) {
-        std::map<std::string, GpiObjHdl *>::iterator it;
-
         const std::string &name = hdl->get_fullname();
 
         LOG_DEBUG("Checking %s exists", name.c_str());
 
-        it = handle_map.find(name);
+        auto it = handle_map.find(name);
         if (it == handle_map.end()) {
-            handle_map[name] = hdl;
+            handle_map.emplace(name, hdl);
             return hdl;
         } else {
             LOG_DEBUG("Found duplicate %s", name.c_str());
@@ -45,20 +50,65 @@ class GpiHandleStore {
         }
     }
 
+    // Children already looked up or discovered are indexed by their parent
+    // and their interned name or index, so finding them again doesn't need
+    // their full name or a trip through the simulator.
+    GpiObjHdl *find_child(GpiObjHdl *parent, const std::string &name) {
+        auto name_it = names.find(name);
+        if (name_it == names.end()) {
+            return NULL;
+        }
+        auto it = children_by_name.find({parent, &*name_it});
+        return it == children_by_name.end() ? NULL : it->second;
+    }
+
+    GpiObjHdl *find_child(GpiObjHdl *parent, int32_t index) {
+        auto it = children_by_index.find({parent, index});
+        return it == children_by_index.end() ? NULL : it->second;
+    }
+
+    void add_child(GpiObjHdl *parent, const std::string &name,
+                   GpiObjHdl *hdl) {
+        // Set elements never move, so the interned name can be used as key
+        const std::string *interned = &*names.insert(name).first;
+        children_by_name[{parent, interned}] = hdl;
+    }
+
+    void add_child(GpiObjHdl *parent, int32_t index, GpiObjHdl *hdl) {
+        children_by_index[{parent, index}] = hdl;
+    }
+
     uint64_t handle_count() { return handle_map.size(); }
 
     void clear() {
-        std::map<std::string, GpiObjHdl *>::iterator it;
-
         // Delete the object handles before clearing the map
-        for (it = handle_map.begin(); it != handle_map.end(); it++) {
-            delete (it->second);
+        for (auto &entry : handle_map) {
+            delete entry.second;
         }
         handle_map.clear();
+        children_by_name.clear();
+        children_by_index.clear();
+        names.clear();
     }
 
   private:
-    std::map<std::string, GpiObjHdl *> handle_map;
+    struct ChildKeyHash {
+        template <typename T>
+        size_t operator()(const std::pair<GpiObjHdl *, T> &key) const {
+            size_t seed = std::hash<GpiObjHdl *>()(key.first);
+            return seed ^ (std::hash<T>()(key.second) + 0x9e3779b9 +
+                           (seed << 6) + (seed >> 2));
+        }
+    };
+
+    std::unordered_map<std::string, GpiObjHdl *> handle_map;
+    std::unordered_set<std::string> names;
+    std::unordered_map<std::pair<GpiObjHdl *, const std::string *>,
+                       GpiObjHdl *, ChildKeyHash>
+        children_by_name;
+    std::unordered_map<std::pair<GpiObjHdl *, int32_t>, GpiObjHdl *,
+                       ChildKeyHash>
+        children_by_index;
 };
 
 static GpiHandleStore unique_handles;
@@ -68,6 +118,24 @@ static GpiHandleStore unique_handles;
 
 static bool gpi_finalizing = false;
 
+static bool checkpoints_enabled = false;
+static int checkpoint_request = 0;
+static int checkpoint_index = 0;
+static bool checkpoint_failed = false;
+
+static bool trace_control_enabled = false;
+static bool trace_ring_supported = false;
+static uint64_t trace_start = 0;
+static uint64_t trace_stop = UINT64_MAX;
+static vector<pair<GpiSignalObjHdl *, long>> trace_trigger;
+static int trace_ring = 0;
+static bool trace_save_request = false;
+
+// A deque, so counters don't move as more are added
+static deque<pair<string, uint64_t>> profile_counters;
+static uint64_t profile_start_ticks;
+static chrono::steady_clock::time_point profile_start_time;
+
 static size_t gpi_print_registered_impl() {
     vector<GpiImplInterface *>::iterator iter;
     for (iter = registered_impls.begin(); iter != registered_impls.end();
@@ -289,6 +357,14 @@ GPI_EXPORT void gpi_init_logging_and_debug() {
         }
     }
 
+    const char *log_async_env = getenv("GPI_LOG_ASYNC");
+    if (log_async_env) {
+        std::string log_async = log_async_env;
+        if (log_async != "0") {
+            gpi_log_async_enable();
+        }
+    }
+
     const char *log_level = getenv("GPI_LOG_LEVEL");
     if (log_level) {
         static const std::map<std::string, int> log_level_str_table = {
@@ -329,6 +405,205 @@ const char *gpi_get_simulator_version() {
     return registered_impls[0]->get_simulator_version();
 }
 
+void gpi_enable_checkpoints() { checkpoints_enabled = true; }
+
+int gpi_request_checkpoint(int n_children) {
+    if (!checkpoints_enabled) {
+        LOG_ERROR("Checkpoints are not supported by this simulator");
+        return -1;
+    }
+    if (checkpoint_index != 0) {
+        LOG_ERROR("Checkpoints can only be taken in the original process");
+        return -1;
+    }
+    if (n_children < 1 || checkpoint_request != 0) {
+        LOG_ERROR("Invalid checkpoint request for %d children", n_children);
+        return -1;
+    }
+    checkpoint_request = n_children;
+    return 0;
+}
+
+int gpi_take_checkpoint_request() {
+    int n_children = checkpoint_request;
+    checkpoint_request = 0;
+    if (n_children) {
+        // Only the forking thread is copied into the children, so stop the
+        // log writer until gpi_set_checkpoint_index()
+        gpi_log_async_pause();
+    }
+    return n_children;
+}
+
+void gpi_set_checkpoint_index(int index) {
+    gpi_log_async_resume();
+    // A failed checkpoint leaves us in the original process, which can still
+    // take further checkpoints
+    checkpoint_failed = index < 0;
+    checkpoint_index = checkpoint_failed ? 0 : index;
+}
+
+int gpi_get_checkpoint_index() {
+    return checkpoint_failed ? -1 : checkpoint_index;
+}
+
+void gpi_enable_trace_control(bool ring) {
+    trace_control_enabled = true;
+    trace_ring_supported = ring;
+}
+
+int gpi_trace_set_window(uint64_t start, uint64_t stop) {
+    if (!trace_control_enabled) {
+        LOG_ERROR("Trace control is not supported by this simulator");
+        return -1;
+    }
+    if (stop <= start) {
+        LOG_ERROR("Invalid trace window, stop must be after start");
+        return -1;
+    }
+    trace_start = start;
+    trace_stop = stop;
+    return 0;
+}
+
+int gpi_trace_set_trigger(int n_terms, const gpi_sim_hdl *sig_hdls,
+                          const long *values) {
+    if (!trace_control_enabled) {
+        LOG_ERROR("Trace control is not supported by this simulator");
+        return -1;
+    }
+    vector<pair<GpiSignalObjHdl *, long>> terms;
+    for (int i = 0; i < n_terms; i++) {
+        switch (sig_hdls[i]->get_type()) {
+            case GPI_LOGIC:
+            case GPI_LOGIC_ARRAY:
+            case GPI_INTEGER:
+            case GPI_ENUM:
+                break;
+            default:
+                LOG_ERROR("Trace trigger %s is not a signal",
+                          sig_hdls[i]->get_fullname_str());
+                return -1;
+        }
+        terms.emplace_back(static_cast<GpiSignalObjHdl *>(sig_hdls[i]),
+                           values[i]);
+    }
+    trace_trigger = std::move(terms);
+    return 0;
+}
+
+int gpi_trace_set_ring(int steps) {
+    if (!trace_ring_supported) {
+        LOG_ERROR("A trace ring is not supported by this simulator");
+        return -1;
+    }
+    if (steps < 0) {
+        LOG_ERROR("Invalid trace ring of %d time steps", steps);
+        return -1;
+    }
+    trace_ring = steps;
+    return 0;
+}
+
+int gpi_trace_save_ring() {
+    if (!trace_ring) {
+        LOG_ERROR("There is no trace ring to save");
+        return -1;
+    }
+    trace_save_request = true;
+    return 0;
+}
+
+bool gpi_trace_active(uint64_t time) {
+    if (time < trace_start || time >= trace_stop) {
+        return false;
+    }
+    for (auto &term : trace_trigger) {
+        if (term.first->get_signal_value_long() != term.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int gpi_get_trace_ring() { return trace_ring; }
+
+bool gpi_take_trace_save_request() {
+    bool request = trace_save_request;
+    trace_save_request = false;
+    return request;
+}
+
+static bool gpi_profiling() {
+    static const bool enabled = [] {
+        const char *profile_env = getenv("GPI_PROFILE");
+        if (!profile_env || string(profile_env) == "0") {
+            return false;
+        }
+        profile_start_ticks = profile_ticks();
+        profile_start_time = chrono::steady_clock::now();
+        return true;
+    }();
+    return enabled;
+}
+
+uint64_t *gpi_profile_counter(const char *name) {
+    if (!gpi_profiling()) {
+        return nullptr;
+    }
+    for (auto &counter : profile_counters) {
+        if (counter.first == name) {
+            return &counter.second;
+        }
+    }
+    profile_counters.emplace_back(name, 0);
+    return &profile_counters.back().second;
+}
+
+int gpi_get_profile_counter(int index, const char **name, uint64_t *value) {
+    if (index < 0 || static_cast<size_t>(index) >= profile_counters.size()) {
+        return -1;
+    }
+    *name = profile_counters[index].first.c_str();
+    *value = profile_counters[index].second;
+    return 0;
+}
+
+double gpi_get_profile_tick_rate() {
+    if (!gpi_profiling()) {
+        return 0.0;
+    }
+    // Calibrate the ticks against the system clock over the whole run
+    uint64_t ticks = profile_ticks() - profile_start_ticks;
+    chrono::duration<double> elapsed =
+        chrono::steady_clock::now() - profile_start_time;
+    if (elapsed.count() <= 0.0) {
+        return 0.0;  // LCOV_EXCL_LINE
+    }
+    return ticks / elapsed.count();
+}
+
+void gpi_write_profile(const char *filename) {
+    if (!gpi_profiling()) {
+        return;
+    }
+    FILE *f = fopen(filename, "w");
+    if (!f) {
+        LOG_ERROR("Could not write the profile to %s", filename);
+        return;
+    }
+    fprintf(f, "{\n  \"ticks_per_second\": %.0f,\n  \"counters\": {",
+            gpi_get_profile_tick_rate());
+    const char *sep = "\n";
+    for (auto &counter : profile_counters) {
+        fprintf(f, "%s    \"%s\": %llu", sep, counter.first.c_str(),
+                static_cast<unsigned long long>(counter.second));
+        sep = ",\n";
+    }
+    fprintf(f, "\n  }\n}\n");
+    fclose(f);
+}
+
 gpi_sim_hdl gpi_get_root_handle(const char *name) {
     /* May need to look over all the implementations that are registered
        to find this handle */
@@ -439,8 +714,14 @@ gpi_sim_hdl gpi_get_handle_by_name(gpi_sim_hdl base, const char *name,
     std::string s_name = name;
     GpiObjHdl *hdl = NULL;
     if (discovery_method == GPI_AUTO) {
+        hdl = unique_handles.find_child(base, s_name);
+        if (hdl) {
+            return hdl;
+        }
         hdl = gpi_get_child_by_name(base, s_name, NULL);
-        if (!hdl) {
+        if (hdl) {
+            unique_handles.add_child(base, s_name, hdl);
+        } else {
             LOG_DEBUG(
                 "Failed to find a handle named %s via any registered "
                 "implementation",
@@ -462,7 +743,10 @@ gpi_sim_hdl gpi_get_handle_by_name(gpi_sim_hdl base, const char *name,
 }
 
 gpi_sim_hdl gpi_get_handle_by_index(gpi_sim_hdl base, int32_t index) {
-    GpiObjHdl *hdl = NULL;
+    GpiObjHdl *hdl = unique_handles.find_child(base, index);
+    if (hdl) {
+        return hdl;
+    }
     GpiImplInterface *intf = base->m_impl;
 
     /* Shouldn't need to iterate over interfaces because indexing into a handle
@@ -475,9 +759,11 @@ gpi_sim_hdl gpi_get_handle_by_index(gpi_sim_hdl base, int32_t index) {
               intf->get_name_c());
     hdl = intf->get_child_by_index(index, base);
 
-    if (hdl)
-        return CHECK_AND_STORE(hdl);
-    else {
+    if (hdl) {
+        hdl = CHECK_AND_STORE(hdl);
+        unique_handles.add_child(base, index, hdl);
+        return hdl;
+    } else {
         LOG_WARN(
             "Failed to find a handle at index %d via any registered "
             "implementation",
@@ -559,6 +845,72 @@ gpi_sim_hdl gpi_next(gpi_iterator_hdl iter) {
     }
 }
 
+// The index of an element of a generate array, from the end of its name:
+// "name[3]" (VPI), "name(3)" (FLI, VHPI) or "name__3" (VHPI on Aldec)
+static bool get_genarray_index(const std::string &name, int32_t *index) {
+    std::string::size_type start;
+    std::string::size_type end = name.size();
+    if (!name.empty() && (name.back() == ']' || name.back() == ')')) {
+        start = name.rfind(name.back() == ']' ? '[' : '(');
+        end--;
+    } else {
+        start = name.rfind("__");
+        if (start != std::string::npos) {
+            start++;
+        }
+    }
+    if (start == std::string::npos || start + 1 >= end) {
+        return false;
+    }
+    int32_t value = 0;
+    for (auto i = start + 1; i < end; i++) {
+        if (name[i] < '0' || name[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (name[i] - '0');
+    }
+    *index = value;
+    return true;
+}
+
+int gpi_discover_scope(gpi_sim_hdl base, int depth) {
+    gpi_iterator_hdl iter = gpi_iterate(base, GPI_OBJECTS);
+    if (!iter) {
+        return 0;
+    }
+
+    int count = 0;
+    std::vector<GpiObjHdl *> scopes;
+    bool genarray = base->get_type() == GPI_GENARRAY;
+    while (GpiObjHdl *child = gpi_next(iter)) {
+        unique_handles.add_child(base, child->get_name(), child);
+        int32_t index;
+        if (genarray && get_genarray_index(child->get_name(), &index)) {
+            unique_handles.add_child(base, index, child);
+        }
+        count++;
+
+        switch (child->get_type()) {
+            case GPI_MODULE:
+            case GPI_GENARRAY:
+            case GPI_STRUCTURE:
+                scopes.push_back(child);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Walk nested scopes once this iterator is done with
+    if (depth != 0) {
+        for (auto scope : scopes) {
+            count += gpi_discover_scope(scope, depth - 1);
+        }
+    }
+    LOG_DEBUG("Discovered %d objects below %s", count, base->get_name_str());
+    return count;
+}
+
 const char *gpi_get_definition_name(gpi_sim_hdl obj_hdl) {
     return obj_hdl->get_definition_name();
 }
@@ -592,6 +944,12 @@ long gpi_get_signal_value_long(gpi_sim_hdl sig_hdl) {
     return obj_hdl->get_signal_value_long();
 }
 
+int gpi_get_signal_value_vector(gpi_sim_hdl sig_hdl, uint32_t *words,
+                                int n_pairs) {
+    GpiSignalObjHdl *obj_hdl = static_cast<GpiSignalObjHdl *>(sig_hdl);
+    return obj_hdl->get_signal_value_vector(words, n_pairs);
+}
+
 const char *gpi_get_signal_name_str(gpi_sim_hdl sig_hdl) {
     GpiSignalObjHdl *obj_hdl = static_cast<GpiSignalObjHdl *>(sig_hdl);
     return obj_hdl->get_name_str();
@@ -629,6 +987,12 @@ void gpi_set_signal_value_binstr(gpi_sim_hdl sig_hdl, const char *binstr,
     obj_hdl->set_signal_value_binstr(value, action);
 }
 
+int gpi_set_signal_value_vector(gpi_sim_hdl sig_hdl, const uint32_t *words,
+                                int n_pairs, gpi_set_action action) {
+    GpiSignalObjHdl *obj_hdl = static_cast<GpiSignalObjHdl *>(sig_hdl);
+    return obj_hdl->set_signal_value_vector(words, n_pairs, action);
+}
+
 void gpi_set_signal_value_str(gpi_sim_hdl sig_hdl, const char *str,
                               gpi_set_action action) {
     std::string value = str;
@@ -673,6 +1037,20 @@ gpi_cb_hdl gpi_register_value_change_callback(int (*gpi_function)(void *),
     }
 }
 
+gpi_cb_hdl gpi_register_persistent_value_change_callback(
+    int (*gpi_function)(void *), void *gpi_cb_data, gpi_sim_hdl sig_hdl,
+    gpi_edge edge) {
+    GpiCbHdl *gpi_hdl = gpi_register_value_change_callback(
+        gpi_function, gpi_cb_data, sig_hdl, edge);
+    if (gpi_hdl && gpi_hdl->set_persistent()) {
+        LOG_DEBUG("%s does not support persistent value change callbacks",
+                  gpi_hdl->m_impl->get_name_c());
+        gpi_hdl->remove();
+        return NULL;
+    }
+    return gpi_hdl;
+}
+
 gpi_cb_hdl gpi_register_timed_callback(int (*gpi_function)(void *),
                                        void *gpi_cb_data, uint64_t time) {
     // It should not matter which implementation we use for this so just pick
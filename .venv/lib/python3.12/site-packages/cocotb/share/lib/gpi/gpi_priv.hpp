@@ -120,6 +120,9 @@ class GPI_EXPORT GpiSignalObjHdl : public GpiObjHdl {
     virtual const char *get_signal_value_str() = 0;
     virtual double get_signal_value_real() = 0;
     virtual long get_signal_value_long() = 0;
+    // Copy the value as (aval, bval) word pairs, see
+    // gpi_get_signal_value_vector(). Not every implementation supports this.
+    virtual int get_signal_value_vector(uint32_t *words, int n_pairs);
 
     int m_length = 0;
 
@@ -130,6 +133,8 @@ class GPI_EXPORT GpiSignalObjHdl : public GpiObjHdl {
                                      gpi_set_action action) = 0;
     virtual int set_signal_value_binstr(std::string &value,
                                         gpi_set_action action) = 0;
+    virtual int set_signal_value_vector(const uint32_t *words, int n_pairs,
+                                        gpi_set_action action);
     // virtual GpiCbHdl monitor_value(bool rising_edge) = 0; this was for the
     // triggers
     // but the explicit ones are probably better
@@ -183,6 +188,13 @@ class GPI_EXPORT GpiCbHdl : public GpiHdl {
      */
     virtual int remove() = 0;
 
+    /** Keep the callback armed after it fires, until remove() is called.
+     *
+     * Secondary initialization routine, called after arm().
+     * @return `0` on success, `-1` if the callback can't be persistent.
+     */
+    virtual int set_persistent() { return -1; }
+
     /** Run the callback.
      *
      * This function should delete the object if it can't fire again.
@@ -272,6 +284,25 @@ GPI_EXPORT int gpi_register_impl(GpiImplInterface *func_tbl);
 GPI_EXPORT void gpi_start_of_sim_time(int argc, char const *const *argv);
 GPI_EXPORT void gpi_end_of_sim_time();
 
+// Simulators which can fork between time steps enable checkpoints, then take
+// any pending gpi_request_checkpoint() at the end of each time step and report
+// back which process they are after forking. Taking a request pauses the
+// asynchronous log writer until then.
+GPI_EXPORT void gpi_enable_checkpoints();
+GPI_EXPORT int gpi_take_checkpoint_request();
+GPI_EXPORT void gpi_set_checkpoint_index(int index);
+
+// Simulators which own the trace enable trace control, then at the end of
+// each time step check whether to trace it, and take any pending
+// gpi_trace_save_ring() request.
+GPI_EXPORT void gpi_enable_trace_control(bool ring);
+GPI_EXPORT bool gpi_trace_active(uint64_t time);
+GPI_EXPORT int gpi_get_trace_ring();
+GPI_EXPORT bool gpi_take_trace_save_request();
+
+// Write every profile counter to a JSON file, if profiling is enabled
+GPI_EXPORT void gpi_write_profile(const char *filename);
+
 GPI_EXPORT void gpi_entry_point();
 GPI_EXPORT void gpi_check_cleanup();
 GPI_EXPORT void gpi_init_logging_and_debug();
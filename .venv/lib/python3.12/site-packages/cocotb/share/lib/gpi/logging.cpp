@@ -6,10 +6,19 @@
 
 #include <gpi_logging.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdarg>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "../utils.hpp"  // DEFER
@@ -21,6 +30,16 @@ static gpi_log_filter_ftype current_filter = nullptr;
 static gpi_log_set_level_ftype current_set_level = nullptr;
 static void *current_userdata = nullptr;
 
+namespace {
+class AsyncLog;
+}
+static AsyncLog *async_log = nullptr;
+static void async_log_push(const char *name, int level, const char *pathname,
+                           const char *funcname, long lineno, const char *msg,
+                           va_list argp);
+static void async_log_flush();
+static int native_logger_level();
+
 extern "C" void gpi_log_(const char *name, int level, const char *pathname,
                          const char *funcname, long lineno, const char *msg,
                          ...) {
@@ -33,6 +52,17 @@ extern "C" void gpi_log_(const char *name, int level, const char *pathname,
 extern "C" void gpi_vlog_(const char *name, int level, const char *pathname,
                           const char *funcname, long lineno, const char *msg,
                           va_list argp) {
+    if (async_log) {
+        if (level < GPI_WARNING) {
+            if (level >= native_logger_level()) {
+                async_log_push(name, level, pathname, funcname, lineno, msg,
+                               argp);
+            }
+            return;
+        }
+        // Keep warnings and errors in order with what was logged before them
+        async_log_flush();
+    }
     if (current_handler) {
         (*current_handler)(current_userdata, name, level, pathname, funcname,
                            lineno, msg, argp);
@@ -117,15 +147,38 @@ extern "C" void gpi_native_logger_log_(const char *name, int level,
     va_end(argp);
 }
 
+static int native_logger_level() {
+    if (current_native_logger_level == GPI_NOTSET) {
+        return GPI_INFO;
+    }
+    return current_native_logger_level;
+}
+
+static void native_logger_write(const char *name, int level,
+                                const char *pathname, const char *funcname,
+                                long lineno, const char *text) {
+    fprintf(stdout, "     -.--ns ");
+    fprintf(stdout, "%-9s", gpi_log_level_to_str(level));
+    fprintf(stdout, "%-35s", name);
+
+    size_t pathlen = strlen(pathname);
+    if (pathlen > 20) {
+        fprintf(stdout, "..%18s:", (pathname + (pathlen - 18)));
+    } else {
+        fprintf(stdout, "%20s:", pathname);
+    }
+
+    fprintf(stdout, "%-4ld", lineno);
+    fprintf(stdout, " in %-31s ", funcname);
+    fprintf(stdout, "%s", text);
+    fprintf(stdout, "\n");
+}
+
 extern "C" void gpi_native_logger_vlog_(const char *name, int level,
                                         const char *pathname,
                                         const char *funcname, long lineno,
                                         const char *msg, va_list argp) {
-    int curr_level = current_native_logger_level;
-    if (current_native_logger_level == GPI_NOTSET) {
-        curr_level = GPI_INFO;
-    }
-    if (level < curr_level) {
+    if (level < native_logger_level()) {
         return;
     }
 
@@ -170,21 +223,8 @@ extern "C" void gpi_native_logger_vlog_(const char *name, int level,
         }
     }
 
-    fprintf(stdout, "     -.--ns ");
-    fprintf(stdout, "%-9s", gpi_log_level_to_str(level));
-    fprintf(stdout, "%-35s", name);
-
-    size_t pathlen = strlen(pathname);
-    if (pathlen > 20) {
-        fprintf(stdout, "..%18s:", (pathname + (pathlen - 18)));
-    } else {
-        fprintf(stdout, "%20s:", pathname);
-    }
-
-    fprintf(stdout, "%-4ld", lineno);
-    fprintf(stdout, " in %-31s ", funcname);
-    fprintf(stdout, "%s", log_buff.data());
-    fprintf(stdout, "\n");
+    native_logger_write(name, level, pathname, funcname, lineno,
+                        log_buff.data());
     fflush(stdout);
 }
 
@@ -197,3 +237,546 @@ extern "C" int gpi_native_logger_set_level(int level) {
 extern "C" bool gpi_native_logger_filtered(int level) {
     return level >= current_native_logger_level;
 }
+
+/*******************************************************************************
+ * GPI Asynchronous Logger
+ *******************************************************************************/
+
+namespace {
+
+// How a printf conversion takes its argument
+enum class ArgKind { NONE, INT, UINT, DOUBLE, STRING, POINTER, UNSUPPORTED };
+
+enum class ArgLength { NONE, HH, H, L, LL, J, Z, T, BIG_L };
+
+struct Conversion {
+    const char *end;  // one past the conversion character
+    int n_stars;      // '*' width and precision, each taking an int argument
+    ArgLength length;
+    ArgKind kind;
+};
+
+// Parse the conversion starting at the '%' at *p*
+Conversion parse_conversion(const char *p) {
+    Conversion conv{p + 1, 0, ArgLength::NONE, ArgKind::UNSUPPORTED};
+    const char *q = p + 1;
+    while (*q && strchr("-+ #0", *q)) {
+        q++;
+    }
+    if (*q == '*') {
+        conv.n_stars++;
+        q++;
+    }
+    while (*q >= '0' && *q <= '9') {
+        q++;
+    }
+    if (*q == '.') {
+        q++;
+        if (*q == '*') {
+            conv.n_stars++;
+            q++;
+        }
+        while (*q >= '0' && *q <= '9') {
+            q++;
+        }
+    }
+    switch (*q) {
+        case 'h':
+            conv.length = q[1] == 'h' ? ArgLength::HH : ArgLength::H;
+            break;
+        case 'l':
+            conv.length = q[1] == 'l' ? ArgLength::LL : ArgLength::L;
+            break;
+        case 'j':
+            conv.length = ArgLength::J;
+            break;
+        case 'z':
+            conv.length = ArgLength::Z;
+            break;
+        case 't':
+            conv.length = ArgLength::T;
+            break;
+        case 'L':
+            conv.length = ArgLength::BIG_L;
+            break;
+    }
+    if (conv.length == ArgLength::HH || conv.length == ArgLength::LL) {
+        q += 2;
+    } else if (conv.length != ArgLength::NONE) {
+        q++;
+    }
+    if (!*q) {
+        conv.end = q;
+        return conv;
+    }
+    conv.end = q + 1;
+    switch (*q) {
+        case '%':
+            conv.kind = ArgKind::NONE;
+            break;
+        case 'd':
+        case 'i':
+            conv.kind = ArgKind::INT;
+            break;
+        case 'c':
+            if (conv.length == ArgLength::NONE) {
+                conv.kind = ArgKind::INT;
+            }
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            conv.kind = ArgKind::UINT;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            conv.kind = ArgKind::DOUBLE;
+            break;
+        case 's':
+            if (conv.length == ArgLength::NONE) {
+                conv.kind = ArgKind::STRING;
+            }
+            break;
+        case 'p':
+            conv.kind = ArgKind::POINTER;
+            break;
+    }
+    return conv;
+}
+
+template <typename T>
+void put(std::vector<char> &out, T value) {
+    const char *bytes = reinterpret_cast<const char *>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+T get(const char *&in) {
+    T value;
+    memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+    return value;
+}
+
+void put_string(std::vector<char> &out, const char *str, size_t len) {
+    out.insert(out.end(), str, str + len);
+    out.push_back('\0');
+}
+
+// Copy the arguments of *msg* to *out*, or return false if it has a conversion
+// that isn't supported
+bool encode_args(const char *msg, va_list args, std::vector<char> &out) {
+    for (const char *p = strchr(msg, '%'); p;) {
+        Conversion conv = parse_conversion(p);
+        for (int i = 0; i < conv.n_stars; i++) {
+            put<long long>(out, va_arg(args, int));
+        }
+        switch (conv.kind) {
+            case ArgKind::NONE:
+                break;
+            case ArgKind::INT: {
+                long long value;
+                switch (conv.length) {
+                    case ArgLength::HH:
+                        value = (signed char)va_arg(args, int);
+                        break;
+                    case ArgLength::H:
+                        value = (short)va_arg(args, int);
+                        break;
+                    case ArgLength::L:
+                        value = va_arg(args, long);
+                        break;
+                    case ArgLength::LL:
+                        value = va_arg(args, long long);
+                        break;
+                    case ArgLength::J:
+                        value = va_arg(args, intmax_t);
+                        break;
+                    case ArgLength::Z:
+                    case ArgLength::T:
+                        value = va_arg(args, ptrdiff_t);
+                        break;
+                    default:
+                        value = va_arg(args, int);
+                        break;
+                }
+                put(out, value);
+                break;
+            }
+            case ArgKind::UINT: {
+                unsigned long long value;
+                switch (conv.length) {
+                    case ArgLength::HH:
+                        value = (unsigned char)va_arg(args, unsigned int);
+                        break;
+                    case ArgLength::H:
+                        value = (unsigned short)va_arg(args, unsigned int);
+                        break;
+                    case ArgLength::L:
+                        value = va_arg(args, unsigned long);
+                        break;
+                    case ArgLength::LL:
+                        value = va_arg(args, unsigned long long);
+                        break;
+                    case ArgLength::J:
+                        value = va_arg(args, uintmax_t);
+                        break;
+                    case ArgLength::Z:
+                    case ArgLength::T:
+                        value = va_arg(args, size_t);
+                        break;
+                    default:
+                        value = va_arg(args, unsigned int);
+                        break;
+                }
+                put(out, value);
+                break;
+            }
+            case ArgKind::DOUBLE:
+                if (conv.length == ArgLength::BIG_L) {
+                    put(out, (double)va_arg(args, long double));
+                } else {
+                    put(out, va_arg(args, double));
+                }
+                break;
+            case ArgKind::STRING: {
+                const char *str = va_arg(args, const char *);
+                if (!str) {
+                    str = "(null)";
+                }
+                put_string(out, str, strlen(str));
+                break;
+            }
+            case ArgKind::POINTER:
+                put(out, (uint64_t)(uintptr_t)va_arg(args, void *));
+                break;
+            case ArgKind::UNSUPPORTED:
+                return false;
+        }
+        p = strchr(conv.end, '%');
+    }
+    return true;
+}
+
+template <typename T>
+void append_format(std::string &out, const char *spec, T value) {
+    char buf[64];
+    int n = snprintf(buf, sizeof(buf), spec, value);
+    if (n < 0) {
+        return;  // LCOV_EXCL_LINE
+    }
+    if ((size_t)n < sizeof(buf)) {
+        out.append(buf, (size_t)n);
+        return;
+    }
+    size_t old_size = out.size();
+    out.resize(old_size + (size_t)n + 1);
+    snprintf(&out[old_size], (size_t)n + 1, spec, value);
+    out.resize(old_size + (size_t)n);
+}
+
+// Format *msg* with the arguments copied by encode_args
+void format_args(const char *msg, const char *args, std::string &out) {
+    out.clear();
+    std::string spec;
+    const char *p = msg;
+    for (const char *next = strchr(p, '%'); next; next = strchr(p, '%')) {
+        out.append(p, next);
+        Conversion conv = parse_conversion(next);
+        p = conv.end;
+        if (conv.kind == ArgKind::NONE) {
+            out += '%';
+            continue;
+        }
+
+        // Rebuild the conversion with the stored widths and with the length
+        // modifier of the stored argument
+        spec.clear();
+        for (const char *q = next; q < conv.end - 1; q++) {
+            if (*q == '*') {
+                long long value = get<long long>(args);
+                if (value < 0 && spec.back() == '.') {
+                    spec.pop_back();  // a negative precision is ignored
+                } else {
+                    spec += std::to_string(value);
+                }
+            } else if (!strchr("hljztL", *q)) {
+                spec += *q;
+            }
+        }
+        char type = conv.end[-1];
+        switch (conv.kind) {
+            case ArgKind::INT:
+                if (type == 'c') {
+                    spec += type;
+                    append_format(out, spec.c_str(),
+                                  (int)get<long long>(args));
+                } else {
+                    spec += "ll";
+                    spec += type;
+                    append_format(out, spec.c_str(), get<long long>(args));
+                }
+                break;
+            case ArgKind::UINT:
+                spec += "ll";
+                spec += type;
+                append_format(out, spec.c_str(),
+                              get<unsigned long long>(args));
+                break;
+            case ArgKind::DOUBLE:
+                spec += type;
+                append_format(out, spec.c_str(), get<double>(args));
+                break;
+            case ArgKind::STRING:
+                spec += type;
+                append_format(out, spec.c_str(), args);
+                args += strlen(args) + 1;
+                break;
+            case ArgKind::POINTER:
+                spec += type;
+                append_format(out, spec.c_str(),
+                              (void *)(uintptr_t)get<uint64_t>(args));
+                break;
+            default:
+                break;  // LCOV_EXCL_LINE
+        }
+    }
+    out.append(p);
+}
+
+struct AsyncLogRecord {
+    uint32_t size;  // including the arguments, 0 to wrap to the start
+    int level;
+    long lineno;
+    const char *name;
+    const char *pathname;
+    const char *funcname;
+    const char *msg;
+};
+
+// A single producer, single consumer ring of records, written by the
+// simulation thread and formatted by a background thread. The producer only
+// waits when the ring is full, and only takes the lock to wake the writer
+// when it is idle.
+class AsyncLog {
+  public:
+    static constexpr size_t capacity = 1 << 22;
+
+    AsyncLog() : m_ring(new char[capacity]) { resume(); }
+
+    void push(const char *name, int level, const char *pathname,
+              const char *funcname, long lineno, const char *msg,
+              va_list argp) {
+        m_args.clear();
+        va_list args_copy;
+        va_copy(args_copy, argp);
+        bool encoded = encode_args(msg, args_copy, m_args);
+        va_end(args_copy);
+        if (!encoded) {
+            // Format conversions we can't copy the arguments of here, and
+            // queue the text
+            m_args.clear();
+            va_list argp_copy;
+            va_copy(argp_copy, argp);
+            int n = vsnprintf(NULL, 0, msg, argp_copy);
+            va_end(argp_copy);
+            if (n < 0) {
+                // LCOV_EXCL_START
+                fprintf(stderr,
+                        "Log message construction failed: (error code) %d\n",
+                        n);
+                return;
+                // LCOV_EXCL_STOP
+            }
+            m_args.resize((size_t)n + 1);
+            vsnprintf(m_args.data(), (size_t)n + 1, msg, argp);
+            msg = "%s";
+        }
+
+        size_t size =
+            (sizeof(AsyncLogRecord) + m_args.size() + 7) & ~(size_t)7;
+        if (size > capacity / 4) {
+            // Too big to queue, write it now after what is queued
+            // LCOV_EXCL_START
+            flush();
+            format_args(msg, m_args.data(), m_text);
+            native_logger_write(name, level, pathname, funcname, lineno,
+                                m_text.c_str());
+            fflush(stdout);
+            return;
+            // LCOV_EXCL_STOP
+        }
+
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        size_t pos = head % capacity;
+        size_t to_end = capacity - pos;
+        size_t needed = to_end < size ? to_end + size : size;
+        while (head + needed - m_tail.load(std::memory_order_acquire) >
+               capacity) {
+            std::this_thread::yield();
+        }
+        if (to_end < size) {
+            uint32_t wrap = 0;
+            memcpy(&m_ring[pos], &wrap, sizeof(wrap));
+            head += to_end;
+            pos = 0;
+        }
+        AsyncLogRecord record{(uint32_t)size, level,    lineno, name,
+                              pathname,       funcname, msg};
+        memcpy(&m_ring[pos], &record, sizeof(record));
+        memcpy(&m_ring[pos + sizeof(record)], m_args.data(), m_args.size());
+        // Sequentially consistent with m_idle, so either the writer sees the
+        // record before going idle or we see it idle and wake it
+        m_head.store(head + size);
+        if (!m_thread) {
+            write_queued();
+        } else if (m_idle.load()) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_wake.notify_one();
+        }
+    }
+
+    void flush() {
+        if (!m_thread) {
+            return;  // Nothing is queued while paused
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_drained.wait(lock, [this] { return m_tail.load() == m_head.load(); });
+    }
+
+    // Write everything queued and stop the writer thread, e.g. so that no
+    // thread holds a lock while forking. Messages logged meanwhile are
+    // written at once, so none are left queued to be written twice.
+    void pause() {
+        if (!m_thread) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_thread->join();
+        delete m_thread;
+        m_thread = nullptr;
+        m_stop = false;
+    }
+
+    void resume() {
+        if (!m_thread) {
+            m_thread = new std::thread(&AsyncLog::run, this);
+        }
+    }
+
+  private:
+    void run() {
+        while (true) {
+            write_queued();
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_drained.notify_all();
+            m_idle.store(true);
+            m_wake.wait(lock, [this] {
+                return m_stop || m_head.load() != m_tail.load();
+            });
+            m_idle.store(false);
+            if (m_stop && m_head.load() == m_tail.load()) {
+                return;
+            }
+        }
+    }
+
+    // Format and write the queued records, on the writer thread or, while it
+    // is paused, on the producer
+    void write_queued() {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        if (tail == head) {
+            return;
+        }
+        while (tail != head) {
+            size_t pos = tail % capacity;
+            uint32_t size;
+            memcpy(&size, &m_ring[pos], sizeof(size));
+            if (size == 0) {
+                tail += capacity - pos;
+                continue;
+            }
+            AsyncLogRecord record;
+            memcpy(&record, &m_ring[pos], sizeof(record));
+            format_args(record.msg, &m_ring[pos + sizeof(record)],
+                        m_writer_text);
+            native_logger_write(record.name, record.level, record.pathname,
+                                record.funcname, record.lineno,
+                                m_writer_text.c_str());
+            tail += size;
+        }
+        fflush(stdout);
+        // Only free the space once written, so that flush() returns with
+        // everything written
+        m_tail.store(tail);
+    }
+
+    std::unique_ptr<char[]> m_ring;
+    std::atomic<uint64_t> m_head{0};
+    std::atomic<uint64_t> m_tail{0};
+    std::thread *m_thread = nullptr;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;     // Signals records queued or stopping
+    std::condition_variable m_drained;  // Signals the ring written out
+    std::atomic<bool> m_idle{false};    // The writer waits on m_wake
+    bool m_stop = false;
+    std::vector<char> m_args;   // used by the producer
+    std::string m_text;         // used by the producer
+    std::string m_writer_text;  // used by write_queued()
+};
+
+}  // namespace
+
+static void async_log_push(const char *name, int level, const char *pathname,
+                           const char *funcname, long lineno, const char *msg,
+                           va_list argp) {
+    async_log->push(name, level, pathname, funcname, lineno, msg, argp);
+}
+
+static void async_log_flush() {
+    if (async_log) {
+        async_log->flush();
+    }
+}
+
+static void async_log_stop() {
+    if (async_log) {
+        async_log->pause();
+        delete async_log;
+        async_log = nullptr;
+    }
+}
+
+extern "C" void gpi_log_async_enable(void) {
+    if (async_log) {
+        return;
+    }
+    async_log = new AsyncLog();
+    std::atexit(async_log_stop);
+}
+
+extern "C" void gpi_log_flush(void) { async_log_flush(); }
+
+extern "C" void gpi_log_async_pause(void) {
+    if (async_log) {
+        async_log->pause();
+    }
+}
+
+extern "C" void gpi_log_async_resume(void) {
+    if (async_log) {
+        async_log->resume();
+    }
+}
@@ -10,12 +10,30 @@
 #include "./VpiImpl.hpp"
 
 #ifndef VPI_NO_QUEUE_SETIMMEDIATE_CALLBACKS
-#include <algorithm>
 #include <deque>
 
 static std::deque<VpiCbHdl *> cb_queue;
 #endif
 
+// Count the callbacks fired for each reason, if profiling
+static void profile_vpi_callback(PLI_INT32 reason) {
+    static uint64_t *const total = gpi_profile_counter("vpi.callbacks");
+    static uint64_t *counters[32];
+    if (!total) {
+        return;
+    }
+    ++*total;
+    if (reason < 0 || reason >= 32) {
+        reason = 0;  // Not a reason VpiImpl::reason_to_string() knows
+    }
+    if (!counters[reason]) {
+        counters[reason] = gpi_profile_counter(
+            (std::string("vpi.callbacks.") + VpiImpl::reason_to_string(reason))
+                .c_str());
+    }
+    ++*counters[reason];
+}
+
 static int32_t handle_vpi_callback_(VpiCbHdl *cb_hdl) {
     int error = (!cb_hdl);
     // LCOV_EXCL_START
@@ -40,6 +58,7 @@ static int32_t handle_vpi_callback_(VpiCbHdl *cb_hdl) {
 // Main re-entry point for callbacks from simulator
 int32_t handle_vpi_callback(p_cb_data cb_data) {
     SIM_TO_GPI(VPI, VpiImpl::reason_to_string(cb_data->reason));
+    profile_vpi_callback(cb_data->reason);
 
     int ret = 0;
 #ifdef VPI_NO_QUEUE_SETIMMEDIATE_CALLBACKS
@@ -53,13 +72,16 @@ int32_t handle_vpi_callback(p_cb_data cb_data) {
     static bool reacting = false;
     VpiCbHdl *cb_hdl = (VpiCbHdl *)cb_data->user_data;
     if (reacting) {
-        cb_queue.push_back(cb_hdl);
+        cb_hdl->queue();
     } else {
         reacting = true;
         ret = handle_vpi_callback_(cb_hdl);
         while (!cb_queue.empty()) {
-            handle_vpi_callback_(cb_queue.front());
+            VpiCbHdl *queued = cb_queue.front();
             cb_queue.pop_front();
+            if (queued->dequeue()) {
+                handle_vpi_callback_(queued);
+            }
         }
         reacting = false;
     }
@@ -98,20 +120,43 @@ int VpiCbHdl::arm() {
     return 0;
 }
 
+#ifndef VPI_NO_QUEUE_SETIMMEDIATE_CALLBACKS
+void VpiCbHdl::queue() {
+    cb_queue.push_back(this);
+    m_queued++;
+}
+
+bool VpiCbHdl::dequeue() {
+    m_queued--;
+    if (m_removed_in_queue) {
+        if (!m_queued) {
+            delete this;
+        }
+        return false;
+    }
+    return true;
+}
+#endif
+
 int VpiCbHdl::remove() {
 #ifndef VPI_NO_QUEUE_SETIMMEDIATE_CALLBACKS
     // check if it's already fired and is in callback queue
-    auto it = std::find(cb_queue.begin(), cb_queue.end(), this);
-    if (it != cb_queue.end()) {
-        cb_queue.erase(it);
-        // In Verilator some callbacks are recurring, so we *should* try to
-        // remove by falling through to the code below. Other sims don't like
-        // removing callbacks that have already fired.
-#ifndef VERILATOR
-        // It's already fired, we shouldn't try to vpi_remove_cb() it now.
-        delete this;
-        return 0;
+    if (m_queued) {
+        // Rather than search the queue for it, let the queue delete it when
+        // it gets there.
+        m_removed_in_queue = true;
+        // In Verilator some callbacks are recurring, so we *should* still try
+        // to remove it. Other sims don't like removing callbacks that have
+        // already fired.
+#ifdef VERILATOR
+        // LCOV_EXCL_START
+        if (!vpi_remove_cb(get_handle<vpiHandle>())) {
+            LOG_DEBUG("VPI: Unable to remove callback");
+            check_vpi_error();
+        }
+        // LCOV_EXCL_STOP
 #endif
+        return 0;
     }
 #endif
 
@@ -178,6 +223,39 @@ VpiValueCbHdl::VpiValueCbHdl(GpiImplInterface *impl, VpiSignalObjHdl *signal,
     cb_data.obj = m_signal->get_handle<vpiHandle>();
 }
 
+PLI_INT32 VpiValueCbHdl::edge_value() {
+    // Edges are only registered on scalars, so read the value as a scalar
+    // rather than formatting a binary string just to compare it.
+    s_vpi_value value_s;
+#ifdef VERILATOR
+    // Verilator is 2-state and only reads scalars through vpiIntVal
+    value_s.format = vpiIntVal;
+    vpi_get_value(m_signal->get_handle<vpiHandle>(), &value_s);
+    check_vpi_error();
+    return value_s.value.integer ? vpi1 : vpi0;
+#else
+    value_s.format = vpiScalarVal;
+    vpi_get_value(m_signal->get_handle<vpiHandle>(), &value_s);
+    check_vpi_error();
+    return value_s.value.scalar;
+#endif
+}
+
+int VpiValueCbHdl::set_persistent() {
+    m_persistent = true;
+    return 0;
+}
+
+int VpiValueCbHdl::remove() {
+    if (m_running) {
+        // Removed from its own callback, so leave it to run() to remove it
+        // once that returns
+        m_persistent = false;
+        return 0;
+    }
+    return VpiCbHdl::remove();
+}
+
 int VpiValueCbHdl::run() {
     // LCOV_EXCL_START
     if (m_removed) {
@@ -189,11 +267,11 @@ int VpiValueCbHdl::run() {
     bool pass = false;
     switch (m_edge) {
         case GPI_RISING: {
-            pass = !strcmp(m_signal->get_signal_value_binstr(), "1");
+            pass = edge_value() == vpi1;
             break;
         }
         case GPI_FALLING: {
-            pass = !strcmp(m_signal->get_signal_value_binstr(), "0");
+            pass = edge_value() == vpi0;
             break;
         }
         case GPI_VALUE_CHANGE: {
@@ -204,7 +282,14 @@ int VpiValueCbHdl::run() {
 
     int res = 0;
     if (pass) {
+        m_running = true;
         res = m_cb_func(m_cb_data);
+        m_running = false;
+
+        // Persistent callbacks stay armed until removed
+        if (m_persistent) {
+            return res;
+        }
 
         // Remove recurring callback once fired.
         auto err = vpi_remove_cb(get_handle<vpiHandle>());
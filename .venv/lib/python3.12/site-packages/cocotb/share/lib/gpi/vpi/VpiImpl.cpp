@@ -813,6 +813,44 @@ COCOTBVPI_EXPORT void vlog_startup_routines_bootstrap() {
     vpi_main();
     LOG_TRACE("[ VPI (vlog_startup_routines_bootstrap) ] => Sim");
 }
+
+#ifdef VERILATOR
+// Checkpoint hooks for the Verilator harness, which only links against this
+// library
+COCOTBVPI_EXPORT void vlog_checkpoint_enable() { gpi_enable_checkpoints(); }
+
+COCOTBVPI_EXPORT int vlog_checkpoint_take_request() {
+    return gpi_take_checkpoint_request();
+}
+
+COCOTBVPI_EXPORT void vlog_checkpoint_forked(int index) {
+    gpi_set_checkpoint_index(index);
+}
+
+// Trace control hooks, for the same reason
+COCOTBVPI_EXPORT void vlog_trace_control_enable(int ring) {
+    gpi_enable_trace_control(ring != 0);
+}
+
+COCOTBVPI_EXPORT int vlog_trace_active(uint64_t time) {
+    return gpi_trace_active(time);
+}
+
+COCOTBVPI_EXPORT int vlog_trace_ring() { return gpi_get_trace_ring(); }
+
+COCOTBVPI_EXPORT int vlog_trace_take_save_request() {
+    return gpi_take_trace_save_request();
+}
+
+// Profiling hooks, for the same reason
+COCOTBVPI_EXPORT uint64_t *vlog_profile_counter(const char *name) {
+    return gpi_profile_counter(name);
+}
+
+COCOTBVPI_EXPORT void vlog_profile_write(const char *filename) {
+    gpi_write_profile(filename);
+}
+#endif
 }
 
 GPI_ENTRY_POINT(cocotbvpi, register_impl)
@@ -79,41 +79,55 @@ class VpiCbHdl : public GpiCbHdl {
     int remove() override;
     int run() override;
 
+    // Bookkeeping for the queue of callbacks fired while reacting to another
+    void queue();
+    bool dequeue();
+
   protected:
     s_cb_data cb_data;
     s_vpi_time vpi_time;
     bool m_removed = false;
+    int m_queued = 0;                 // Times it's waiting in the queue
+    bool m_removed_in_queue = false;  // Delete when it leaves the queue
 };
 
 class VpiSignalObjHdl;
 
-class VpiValueCbHdl : public VpiCbHdl {
+// The callback handles created on every trigger come from pools rather than
+// the heap.
+class VpiValueCbHdl : public VpiCbHdl, public Pooled<VpiValueCbHdl> {
   public:
     VpiValueCbHdl(GpiImplInterface *impl, VpiSignalObjHdl *sig, gpi_edge edge);
+    int remove() override;
+    int set_persistent() override;
     int run() override;
 
   private:
+    PLI_INT32 edge_value();
+
     s_vpi_value m_vpi_value;
     GpiSignalObjHdl *m_signal;
     gpi_edge m_edge;
+    bool m_persistent = false;
+    bool m_running = false;
 };
 
-class VpiTimedCbHdl : public VpiCbHdl {
+class VpiTimedCbHdl : public VpiCbHdl, public Pooled<VpiTimedCbHdl> {
   public:
     VpiTimedCbHdl(GpiImplInterface *impl, uint64_t time);
 };
 
-class VpiReadOnlyCbHdl : public VpiCbHdl {
+class VpiReadOnlyCbHdl : public VpiCbHdl, public Pooled<VpiReadOnlyCbHdl> {
   public:
     VpiReadOnlyCbHdl(GpiImplInterface *impl);
 };
 
-class VpiNextPhaseCbHdl : public VpiCbHdl {
+class VpiNextPhaseCbHdl : public VpiCbHdl, public Pooled<VpiNextPhaseCbHdl> {
   public:
     VpiNextPhaseCbHdl(GpiImplInterface *impl);
 };
 
-class VpiReadWriteCbHdl : public VpiCbHdl {
+class VpiReadWriteCbHdl : public VpiCbHdl, public Pooled<VpiReadWriteCbHdl> {
   public:
     VpiReadWriteCbHdl(GpiImplInterface *impl);
 };
@@ -194,6 +208,7 @@ class VpiSignalObjHdl : public GpiSignalObjHdl {
     const char *get_signal_value_str() override;
     double get_signal_value_real() override;
     long get_signal_value_long() override;
+    int get_signal_value_vector(uint32_t *words, int n_pairs) override;
 
     int set_signal_value(const int32_t value, gpi_set_action action) override;
     int set_signal_value(const double value, gpi_set_action action) override;
@@ -201,6 +216,8 @@ class VpiSignalObjHdl : public GpiSignalObjHdl {
                                 gpi_set_action action) override;
     int set_signal_value_str(std::string &value,
                              gpi_set_action action) override;
+    int set_signal_value_vector(const uint32_t *words, int n_pairs,
+                                gpi_set_action action) override;
 
     /* Value change callback accessor */
     int initialise(const std::string &name,
@@ -211,6 +228,9 @@ class VpiSignalObjHdl : public GpiSignalObjHdl {
 
   private:
     int set_signal_value(s_vpi_value value, gpi_set_action action);
+
+    // Number of s_vpi_vecval entries in a vpiVectorVal of this object
+    int m_vector_pairs = 0;
 };
 
 class VpiIterator : public GpiIterator {
@@ -91,6 +91,8 @@ int VpiSignalObjHdl::initialise(const std::string &name,
         }
     }
     m_range_dir = m_range_left > m_range_right ? GPI_RANGE_DOWN : GPI_RANGE_UP;
+    m_vector_pairs =
+        (vpi_get(vpiSize, GpiObjHdl::get_handle<vpiHandle>()) + 31) / 32;
     LOG_DEBUG("VPI: %s initialized with %d elements", name.c_str(),
               m_num_elems);
     return GpiObjHdl::initialise(name, fq_name);
@@ -132,6 +134,28 @@ long VpiSignalObjHdl::get_signal_value_long() {
     return value_s.value.integer;
 }
 
+int VpiSignalObjHdl::get_signal_value_vector(uint32_t *words, int n_pairs) {
+    s_vpi_value value_s = {vpiVectorVal, {NULL}};
+
+    vpi_get_value(GpiObjHdl::get_handle<vpiHandle>(), &value_s);
+    check_vpi_error();
+
+    // LCOV_EXCL_START
+    if (!value_s.value.vector) {
+        return -1;
+    }
+    // LCOV_EXCL_STOP
+
+    // The simulator owns the returned array, copy out what fits
+    int n = n_pairs < m_vector_pairs ? n_pairs : m_vector_pairs;
+    for (int i = 0; i < n; i++) {
+        words[2 * i] = static_cast<uint32_t>(value_s.value.vector[i].aval);
+        words[2 * i + 1] = static_cast<uint32_t>(value_s.value.vector[i].bval);
+    }
+
+    return m_vector_pairs;
+}
+
 // Value related functions
 int VpiSignalObjHdl::set_signal_value(int32_t value, gpi_set_action action) {
     s_vpi_value value_s;
@@ -155,15 +179,35 @@ int VpiSignalObjHdl::set_signal_value_binstr(std::string &value,
                                              gpi_set_action action) {
     s_vpi_value value_s;
 
-    std::vector<char> writable(value.begin(), value.end());
-    writable.push_back('\0');
-
-    value_s.value.str = &writable[0];
+    // std::string storage is contiguous and null-terminated, and VPI does not
+    // write through the pointer on a put, so there is no need to copy.
+    value_s.value.str = &value[0];
     value_s.format = vpiBinStrVal;
 
     return set_signal_value(value_s, action);
 }
 
+int VpiSignalObjHdl::set_signal_value_vector(const uint32_t *words,
+                                             int n_pairs,
+                                             gpi_set_action action) {
+    if (n_pairs < m_vector_pairs) {
+        LOG_ERROR("VPI: %d word pairs given to set %s, which needs %d",
+                  n_pairs, get_name_str(), m_vector_pairs);
+        return -1;
+    }
+
+    static_assert(sizeof(s_vpi_vecval) == 2 * sizeof(uint32_t),
+                  "s_vpi_vecval is not a pair of 32-bit words");
+
+    s_vpi_value value_s;
+
+    value_s.value.vector =
+        reinterpret_cast<p_vpi_vecval>(const_cast<uint32_t *>(words));
+    value_s.format = vpiVectorVal;
+
+    return set_signal_value(value_s, action);
+}
+
 int VpiSignalObjHdl::set_signal_value_str(std::string &value,
                                           gpi_set_action action) {
     s_vpi_value value_s;
@@ -233,7 +277,7 @@ GpiCbHdl *VpiSignalObjHdl::register_value_change_callback(
     gpi_edge edge, int (*cb_func)(void *), void *cb_data) {
     VpiValueCbHdl *cb_hdl = new VpiValueCbHdl(this->m_impl, this, edge);
     if (cb_hdl->arm()) {
-        delete this;
+        delete cb_hdl;
         return NULL;
     }
     cb_hdl->set_cb_info(cb_func, cb_data);
@@ -15,9 +15,16 @@
 #include <gpi.h>
 
 #include <cerrno>
+#include <cstdarg>
 #include <cstdint>
-
-#include "../utils.hpp"      // DEFER
+#include <climits>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../utils.hpp"      // DEFER, Pooled
 #include "./pygpi_priv.hpp"  // py_gpi_logger_set_level, c_to_python, python_to_c
 
 // This file defines the routines available to Python
@@ -25,7 +32,8 @@
 #define MODULE_NAME "simulator"
 
 // callback user data
-struct PythonCallback {
+// These are allocated and freed for every trigger, so they come from a pool
+struct PythonCallback : Pooled<PythonCallback> {
     PythonCallback(PyObject *func, PyObject *_args, PyObject *_kwargs)
         : function(func), args(_args), kwargs(_kwargs) {
         Py_XINCREF(function);
@@ -46,6 +54,12 @@ struct PythonCallback {
 class GpiClock;
 using gpi_clk_hdl = GpiClock *;
 
+class GpiPlayer;
+using gpi_player_hdl = GpiPlayer *;
+
+class GpiMonitor;
+using gpi_monitor_hdl = GpiMonitor *;
+
 /* define the extension types as templates */
 namespace {
 template <typename gpi_hdl>
@@ -135,6 +149,10 @@ template <>
 PyTypeObject gpi_hdl_Object<gpi_cb_hdl>::py_type;
 template <>
 PyTypeObject gpi_hdl_Object<gpi_clk_hdl>::py_type;
+template <>
+PyTypeObject gpi_hdl_Object<gpi_player_hdl>::py_type;
+template <>
+PyTypeObject gpi_hdl_Object<gpi_monitor_hdl>::py_type;
 }  // namespace
 
 typedef int (*gpi_function_t)(void *);
@@ -144,6 +162,35 @@ struct sim_time {
     uint32_t low;
 };
 
+/**
+ * @brief Call a Python callback function from GPI
+ * @ingroup python_c_api
+ *
+ * @return 0 on success, -1 if the function raised
+ */
+static int call_python_callback(PyObject *function, PyObject *args,
+                                PyObject *kwargs) {
+    PyObject *pValue = PyObject_Call(function, args, kwargs);
+
+    // If the return value is NULL a Python exception has occurred
+    // The best thing to do here is shutdown as any subsequent
+    // calls will go back to Python which is now in an unknown state
+    if (pValue == NULL) {
+        // Printing a SystemExit calls exit(1), which we don't want.
+        if (!PyErr_ExceptionMatches(PyExc_SystemExit)) {
+            PyErr_Print();
+        }
+        // Clear error so re-entering Python doesn't fail.
+        PyErr_Clear();
+        return -1;
+    }
+
+    // We don't care about the result
+    Py_DECREF(pValue);
+
+    return 0;
+}
+
 /**
  * @name    Callback Handling
  * @brief   Handle a callback coming from GPI
@@ -159,7 +206,18 @@ struct sim_time {
  * are waiting on that particular trigger.
  *
  */
+// Count the callbacks into Python and the time they take, if profiling
+static uint64_t *profile_python_callback() {
+    static uint64_t *const calls = gpi_profile_counter("pygpi.callbacks");
+    static uint64_t *const ticks = gpi_profile_counter("pygpi.callbacks.ticks");
+    if (calls) {
+        ++*calls;
+    }
+    return ticks;
+}
+
 int handle_gpi_callback(void *user_data) {
+    ProfileScope profile(profile_python_callback());
     PYGPI_LOG_TRACE("GPI => [ PYGPI (cocotb.simulator) ]");
     DEFER(PYGPI_LOG_TRACE("[ PYGPI (cocotb.simulator) ] => GPI"));
     c_to_python();
@@ -171,27 +229,40 @@ int handle_gpi_callback(void *user_data) {
     PythonCallback *cb_data = (PythonCallback *)user_data;
     DEFER(delete cb_data);
 
-    // Call the callback
-    PyObject *pValue =
-        PyObject_Call(cb_data->function, cb_data->args, cb_data->kwargs);
+    return call_python_callback(cb_data->function, cb_data->args,
+                                cb_data->kwargs);
+}
 
-    // If the return value is NULL a Python exception has occurred
-    // The best thing to do here is shutdown as any subsequent
-    // calls will go back to Python which is now in an unknown state
-    if (pValue == NULL) {
-        // Printing a SystemExit calls exit(1), which we don't want.
-        if (!PyErr_ExceptionMatches(PyExc_SystemExit)) {
-            PyErr_Print();
-        }
-        // Clear error so re-entering Python doesn't fail.
-        PyErr_Clear();
-        return -1;
-    }
+/**
+ * @brief Handle a callback coming from GPI that stays registered
+ * @ingroup python_c_api
+ *
+ * Like handle_gpi_callback(), but the callback data is kept for the next time
+ * the callback fires. It is freed by deregister(), which the Python function
+ * may itself call, so nothing here touches it after the call.
+ */
+static int handle_gpi_persistent_callback(void *user_data) {
+    ProfileScope profile(profile_python_callback());
+    PYGPI_LOG_TRACE("GPI => [ PYGPI (cocotb.simulator) ]");
+    DEFER(PYGPI_LOG_TRACE("[ PYGPI (cocotb.simulator) ] => GPI"));
+    c_to_python();
+    DEFER(python_to_c());
 
-    // We don't care about the result
-    Py_DECREF(pValue);
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    DEFER(PyGILState_Release(gstate));
 
-    return 0;
+    PythonCallback *cb_data = (PythonCallback *)user_data;
+    PyObject *function = cb_data->function;
+    PyObject *args = cb_data->args;
+    PyObject *kwargs = cb_data->kwargs;
+    Py_INCREF(function);
+    Py_XINCREF(args);
+    Py_XINCREF(kwargs);
+    DEFER(Py_DECREF(function));
+    DEFER(Py_XDECREF(args));
+    DEFER(Py_XDECREF(kwargs));
+
+    return call_python_callback(function, args, kwargs);
 }
 
 // Register a callback for read-only state of sim
@@ -381,13 +452,13 @@ static PyObject *register_timed_callback(PyObject *, PyObject *args) {
     return rv;
 }
 
-// Register signal change callback
+// Register signal change callback, calling handler when it fires
 // First argument should be the signal handle
 // Second argument is the function to call
 // Remaining arguments and keyword arguments are to be passed to the callback
-static PyObject *register_value_change_callback(
-    PyObject *, PyObject *args)  //, PyObject *keywds)
-{
+static PyObject *register_value_change_callback_(PyObject *args,
+                                                 gpi_function_t handler,
+                                                 bool persistent) {
     if (!gpi_has_registered_impl()) {
         PyErr_SetString(PyExc_RuntimeError, "No simulator available!");
         return NULL;
@@ -431,8 +502,19 @@ static PyObject *register_value_change_callback(
 
     PythonCallback *cb_data = new PythonCallback(function, fArgs, NULL);
 
-    gpi_cb_hdl hdl = gpi_register_value_change_callback(
-        (gpi_function_t)handle_gpi_callback, cb_data, sig_hdl, edge);
+    gpi_cb_hdl hdl;
+    if (persistent) {
+        hdl = gpi_register_persistent_value_change_callback(handler, cb_data,
+                                                            sig_hdl, edge);
+    } else {
+        hdl = gpi_register_value_change_callback(handler, cb_data, sig_hdl,
+                                                 edge);
+    }
+    // LCOV_EXCL_START
+    if (!hdl) {
+        delete cb_data;
+    }
+    // LCOV_EXCL_STOP
 
     // Check success
     PyObject *rv = gpi_hdl_New(hdl);
@@ -440,6 +522,21 @@ static PyObject *register_value_change_callback(
     return rv;
 }
 
+static PyObject *register_value_change_callback(
+    PyObject *, PyObject *args)  //, PyObject *keywds)
+{
+    return register_value_change_callback_(
+        args, (gpi_function_t)handle_gpi_callback, false);
+}
+
+// Register a signal change callback that stays registered after it fires,
+// until it is deregistered
+static PyObject *register_persistent_value_change_callback(PyObject *,
+                                                           PyObject *args) {
+    return register_value_change_callback_(
+        args, (gpi_function_t)handle_gpi_persistent_callback, true);
+}
+
 static PyObject *iterate(gpi_hdl_Object<gpi_sim_hdl> *self, PyObject *args) {
     int type;
 
@@ -511,6 +608,26 @@ static PyObject *get_signal_val_long(gpi_hdl_Object<gpi_sim_hdl> *self,
     return PyLong_FromLong(result);
 }
 
+static PyObject *get_signal_val_vector(gpi_hdl_Object<gpi_sim_hdl> *self,
+                                       PyObject *args) {
+    Py_buffer view;
+
+    if (!PyArg_ParseTuple(args, "w*:get_signal_val_vector", &view)) {
+        return NULL;
+    }
+    DEFER(PyBuffer_Release(&view));
+
+    int n_pairs = static_cast<int>(view.len / (2 * sizeof(uint32_t)));
+    int result = gpi_get_signal_value_vector(
+        self->hdl, static_cast<uint32_t *>(view.buf), n_pairs);
+    if (result < 0) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "Failed to get signal value as packed words");
+        return NULL;
+    }
+    return PyLong_FromLong(result);
+}
+
 static PyObject *set_signal_val_binstr(gpi_hdl_Object<gpi_sim_hdl> *self,
                                        PyObject *args) {
     const char *binstr;
@@ -524,6 +641,27 @@ static PyObject *set_signal_val_binstr(gpi_hdl_Object<gpi_sim_hdl> *self,
     Py_RETURN_NONE;
 }
 
+static PyObject *set_signal_val_vector(gpi_hdl_Object<gpi_sim_hdl> *self,
+                                       PyObject *args) {
+    gpi_set_action action;
+    Py_buffer view;
+
+    if (!PyArg_ParseTuple(args, "iy*:set_signal_val_vector", &action, &view)) {
+        return NULL;
+    }
+    DEFER(PyBuffer_Release(&view));
+
+    int n_pairs = static_cast<int>(view.len / (2 * sizeof(uint32_t)));
+    if (gpi_set_signal_value_vector(self->hdl,
+                                    static_cast<const uint32_t *>(view.buf),
+                                    n_pairs, action) < 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "Failed to set signal value from packed words");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
 static PyObject *set_signal_val_str(gpi_hdl_Object<gpi_sim_hdl> *self,
                                     PyObject *args) {
     gpi_set_action action;
@@ -614,6 +752,17 @@ static PyObject *get_handle_by_index(gpi_hdl_Object<gpi_sim_hdl> *self,
     return gpi_hdl_New(result);
 }
 
+static PyObject *discover_scope(gpi_hdl_Object<gpi_sim_hdl> *self,
+                                PyObject *args) {
+    int depth = -1;
+
+    if (!PyArg_ParseTuple(args, "|i:discover_scope", &depth)) {
+        return NULL;
+    }
+
+    return PyLong_FromLong(gpi_discover_scope(self->hdl, depth));
+}
+
 static PyObject *get_root_handle(PyObject *, PyObject *args) {
     const char *name;
 
@@ -751,6 +900,147 @@ static PyObject *stop_simulator(PyObject *, PyObject *) {
     Py_RETURN_NONE;
 }
 
+static PyObject *request_checkpoint(PyObject *, PyObject *args) {
+    int n_children;
+
+    if (!PyArg_ParseTuple(args, "i:request_checkpoint", &n_children)) {
+        return NULL;
+    }
+
+    if (!gpi_has_registered_impl()) {
+        PyErr_SetString(PyExc_RuntimeError, "No simulator available!");
+        return NULL;
+    }
+
+    if (gpi_request_checkpoint(n_children) < 0) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "Simulator refused the checkpoint request");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *get_checkpoint_index(PyObject *, PyObject *) {
+    return PyLong_FromLong(gpi_get_checkpoint_index());
+}
+
+static PyObject *trace_set_window(PyObject *, PyObject *args) {
+    unsigned long long start;
+    unsigned long long stop;
+
+    if (!PyArg_ParseTuple(args, "KK:trace_set_window", &start, &stop)) {
+        return NULL;
+    }
+
+    if (gpi_trace_set_window(start, stop) < 0) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "Simulator refused the trace window");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *trace_set_trigger(PyObject *, PyObject *args) {
+    PyObject *pSignals;
+    PyObject *pValues;
+
+    if (!PyArg_ParseTuple(args, "OO:trace_set_trigger", &pSignals, &pValues)) {
+        return NULL;
+    }
+
+    PyObject *signals =
+        PySequence_Fast(pSignals, "signals must be a sequence");  // New reference
+    if (signals == NULL) {
+        return NULL;
+    }
+    DEFER(Py_DECREF(signals));
+    PyObject *values =
+        PySequence_Fast(pValues, "values must be a sequence");  // New reference
+    if (values == NULL) {
+        return NULL;
+    }
+    DEFER(Py_DECREF(values));
+
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(signals);
+    if (PySequence_Fast_GET_SIZE(values) != n) {
+        PyErr_SetString(PyExc_ValueError,
+                        "Need one value for each trace trigger signal");
+        return NULL;
+    }
+
+    std::vector<gpi_sim_hdl> sig_hdls;
+    std::vector<long> sig_values;
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject *item = PySequence_Fast_GET_ITEM(signals, i);  // borrow reference
+        if (Py_TYPE(item) != &gpi_hdl_Object<gpi_sim_hdl>::py_type) {
+            PyErr_SetString(PyExc_TypeError,
+                            "signals must only contain gpi_sim_hdl");
+            return NULL;
+        }
+        sig_hdls.push_back(((gpi_hdl_Object<gpi_sim_hdl> *)item)->hdl);
+
+        long value = PyLong_AsLong(PySequence_Fast_GET_ITEM(values, i));
+        if (value == -1 && PyErr_Occurred()) {
+            return NULL;
+        }
+        sig_values.push_back(value);
+    }
+
+    if (gpi_trace_set_trigger(static_cast<int>(n), sig_hdls.data(),
+                              sig_values.data()) < 0) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "Simulator refused the trace trigger");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *trace_set_ring(PyObject *, PyObject *args) {
+    int steps;
+
+    if (!PyArg_ParseTuple(args, "i:trace_set_ring", &steps)) {
+        return NULL;
+    }
+
+    if (gpi_trace_set_ring(steps) < 0) {
+        PyErr_SetString(PyExc_RuntimeError, "Simulator refused the trace ring");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *trace_save_ring(PyObject *, PyObject *) {
+    if (gpi_trace_save_ring() < 0) {
+        PyErr_SetString(PyExc_RuntimeError, "There is no trace ring to save");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *get_profile(PyObject *, PyObject *) {
+    PyObject *profile = PyDict_New();  // New reference
+    if (profile == NULL) {
+        return NULL;
+    }
+
+    const char *name;
+    uint64_t value;
+    for (int i = 0; gpi_get_profile_counter(i, &name, &value) == 0; i++) {
+        PyObject *pValue = PyLong_FromUnsignedLongLong(value);  // New reference
+        if (pValue == NULL || PyDict_SetItemString(profile, name, pValue) < 0) {
+            Py_XDECREF(pValue);
+            Py_DECREF(profile);
+            return NULL;
+        }
+        Py_DECREF(pValue);
+    }
+    return profile;
+}
+
+static PyObject *get_profile_tick_rate(PyObject *, PyObject *) {
+    return PyFloat_FromDouble(gpi_get_profile_tick_rate());
+}
+
 static PyObject *deregister(gpi_hdl_Object<gpi_cb_hdl> *self, PyObject *) {
     // cleanup uncalled callback
     void *cb_data;
@@ -982,84 +1272,998 @@ static PyObject *clk_stop(gpi_hdl_Object<gpi_clk_hdl> *self, PyObject *) {
     Py_RETURN_NONE;
 }
 
-static int add_module_constants(PyObject *simulator) {
-    // Make the GPI constants accessible from the C world
-    if (PyModule_AddIntConstant(simulator, "UNKNOWN", GPI_UNKNOWN) < 0 ||
-        PyModule_AddIntConstant(simulator, "MEMORY", GPI_MEMORY) < 0 ||
-        PyModule_AddIntConstant(simulator, "MODULE", GPI_MODULE) < 0 ||
-        PyModule_AddIntConstant(simulator, "NETARRAY", GPI_ARRAY) < 0 ||
-        PyModule_AddIntConstant(simulator, "ENUM", GPI_ENUM) < 0 ||
-        PyModule_AddIntConstant(simulator, "STRUCTURE", GPI_STRUCTURE) < 0 ||
-        PyModule_AddIntConstant(simulator, "PACKED_STRUCTURE",
-                                GPI_PACKED_STRUCTURE) < 0 ||
-        PyModule_AddIntConstant(simulator, "REAL", GPI_REAL) < 0 ||
-        PyModule_AddIntConstant(simulator, "INTEGER", GPI_INTEGER) < 0 ||
-        PyModule_AddIntConstant(simulator, "STRING", GPI_STRING) < 0 ||
-        PyModule_AddIntConstant(simulator, "GENARRAY", GPI_GENARRAY) < 0 ||
-        PyModule_AddIntConstant(simulator, "PACKAGE", GPI_PACKAGE) < 0 ||
-        PyModule_AddIntConstant(simulator, "OBJECTS", GPI_OBJECTS) < 0 ||
-        PyModule_AddIntConstant(simulator, "DRIVERS", GPI_DRIVERS) < 0 ||
-        PyModule_AddIntConstant(simulator, "LOADS", GPI_LOADS) < 0 ||
-        PyModule_AddIntConstant(simulator, "RISING", GPI_RISING) < 0 ||
-        PyModule_AddIntConstant(simulator, "FALLING", GPI_FALLING) < 0 ||
-        PyModule_AddIntConstant(simulator, "VALUE_CHANGE", GPI_VALUE_CHANGE) <
-            0 ||
-        PyModule_AddIntConstant(simulator, "RANGE_UP", GPI_RANGE_UP) < 0 ||
-        PyModule_AddIntConstant(simulator, "RANGE_DOWN", GPI_RANGE_DOWN) < 0 ||
-        PyModule_AddIntConstant(simulator, "RANGE_NO_DIR", GPI_RANGE_NO_DIR) <
-            0 ||
-        PyModule_AddIntConstant(simulator, "LOGIC", GPI_LOGIC) < 0 ||
-        PyModule_AddIntConstant(simulator, "LOGIC_ARRAY", GPI_LOGIC_ARRAY) <
-            0 ||
-        false) {
-        return -1;
-    }
+class GpiPlayer {
+  public:
+    GpiPlayer(GpiObjHdl *clk_sig, std::vector<GpiObjHdl *> drive_sigs,
+              std::vector<GpiObjHdl *> capture_sigs)
+        : clk_signal(clk_sig),
+          drive(std::move(drive_sigs)),
+          capture(std::move(capture_sigs)) {}
+
+    ~GpiPlayer() { stop(); }
+
+    // Replace the stimulus. *words* holds one 32-bit value per drive signal
+    // per cycle, cycle-major. Returns nonzero in case of failure:
+    //  - EBUSY if the player is running (stop first)
+    //  - EINVAL if *n_words* is not a whole number of cycles
+    int load(const uint32_t *words, size_t n_words);
+
+    // Wake Python early when (capture[index] & mask) == value after an edge.
+    // A negative *index* disables the watch. Returns EINVAL if *index* is not
+    // a capture signal.
+    int watch(int index, uint32_t mask, uint32_t value);
+
+    // Start playing the stimulus, applying one row per rising edge of the
+    // clock and calling *done_cb* once the stimulus is exhausted or the watch
+    // fires. Takes ownership of *done_cb* on success. Returns nonzero in case
+    // of failure:
+    //  - EBUSY if the player was already started (stop first)
+    //  - EINVAL if no stimulus is loaded
+    //  - EAGAIN if registering the edge callback failed
+    int start(gpi_set_action set_action, PythonCallback *done_cb);
 
-    return 0;
-}
+    int stop();
 
-// Add the extension types as entries in the module namespace
-static int add_module_types(PyObject *simulator) {
-    PyObject *typ;
+    size_t cycles() const { return m_cycle; }
+    const std::vector<uint32_t> &captured() const { return m_captured; }
 
-    typ = (PyObject *)&gpi_hdl_Object<gpi_sim_hdl>::py_type;
-    Py_INCREF(typ);
-    if (PyModule_AddObject(simulator, "gpi_sim_hdl", typ) < 0) {
-        Py_DECREF(typ);
-        return -1;
-    }
+  private:
+    GpiObjHdl *clk_signal = nullptr;
+    GpiCbHdl *edge_cb_hdl = nullptr;
+    bool m_persistent = false;  // edge_cb_hdl stays armed after firing
+    PythonCallback *m_done_cb = nullptr;
 
-    typ = (PyObject *)&gpi_hdl_Object<gpi_cb_hdl>::py_type;
-    Py_INCREF(typ);
-    if (PyModule_AddObject(simulator, "gpi_cb_hdl", typ) < 0) {
-        Py_DECREF(typ);
-        return -1;
-    }
+    std::vector<GpiObjHdl *> drive;
+    std::vector<GpiObjHdl *> capture;
 
-    typ = (PyObject *)&gpi_hdl_Object<gpi_iterator_hdl>::py_type;
-    Py_INCREF(typ);
-    if (PyModule_AddObject(simulator, "gpi_iterator_hdl", typ) < 0) {
-        Py_DECREF(typ);
-        return -1;
-    }
+    std::vector<uint32_t> m_stimulus;
+    std::vector<uint32_t> m_captured;
+    size_t m_num_cycles = 0;
+    size_t m_cycle = 0;
+    gpi_set_action m_set_action;
 
-    typ = (PyObject *)&gpi_hdl_Object<gpi_clk_hdl>::py_type;
-    Py_INCREF(typ);
-    if (PyModule_AddObject(simulator, "GpiClock", typ) < 0) {
-        // LCOV_EXCL_START
-        Py_DECREF(typ);
-        return -1;
-        // LCOV_EXCL_STOP
+    int m_watch_index = -1;
+    uint32_t m_watch_mask = 0;
+    uint32_t m_watch_value = 0;
+
+    void apply(size_t cycle);
+    int finish();
+    int edge();
+    static int edge_cb(void *gpi_player);
+};
+
+int GpiPlayer::load(const uint32_t *words, size_t n_words) {
+    if (edge_cb_hdl) {
+        return EBUSY;
+    }
+    if (n_words % drive.size()) {
+        return EINVAL;
     }
 
+    m_stimulus.assign(words, words + n_words);
+    m_num_cycles = n_words / drive.size();
     return 0;
 }
 
-/* NOTE: in the following docstrings we are specifying the parameters twice, but
- * this is necessary. The first docstring before the long '--' line specifies
- * the __text_signature__ that is used by the help() function. And the second
- * after the '--' line contains type annotations used by the
- * `autodoc_docstring_signature` setting of sphinx.ext.autodoc for generating
+int GpiPlayer::watch(int index, uint32_t mask, uint32_t value) {
+    if (index >= static_cast<int>(capture.size())) {
+        return EINVAL;
+    }
+    m_watch_index = index;
+    m_watch_mask = mask;
+    m_watch_value = value;
+    return 0;
+}
+
+int GpiPlayer::start(gpi_set_action set_action, PythonCallback *done_cb) {
+    if (edge_cb_hdl) {
+        return EBUSY;
+    }
+    if (m_num_cycles == 0) {
+        return EINVAL;
+    }
+
+    m_set_action = set_action;
+    m_cycle = 0;
+    m_captured.clear();
+    m_captured.reserve(m_num_cycles * capture.size());
+
+    apply(0);
+
+    // Arm one callback for every edge of the run, falling back to one per
+    // edge if the implementation can't keep it armed
+    edge_cb_hdl = gpi_register_persistent_value_change_callback(
+        &GpiPlayer::edge_cb, this, clk_signal, GPI_RISING);
+    m_persistent = edge_cb_hdl != nullptr;
+    if (!edge_cb_hdl) {
+        edge_cb_hdl = gpi_register_value_change_callback(
+            &GpiPlayer::edge_cb, this, clk_signal, GPI_RISING);
+    }
+    if (!edge_cb_hdl) {
+        // LCOV_EXCL_START
+        return EAGAIN;
+        // LCOV_EXCL_STOP
+    }
+
+    m_done_cb = done_cb;
+    return 0;
+}
+
+int GpiPlayer::stop() {
+    if (!edge_cb_hdl) {
+        return -1;
+    }
+    gpi_remove_cb(edge_cb_hdl);
+    edge_cb_hdl = nullptr;
+    delete m_done_cb;
+    m_done_cb = nullptr;
+    return 0;
+}
+
+void GpiPlayer::apply(size_t cycle) {
+    const uint32_t *row = &m_stimulus[cycle * drive.size()];
+    for (size_t i = 0; i < drive.size(); i++) {
+        gpi_set_signal_value_int(drive[i], static_cast<int32_t>(row[i]),
+                                 m_set_action);
+    }
+}
+
+int GpiPlayer::finish() {
+    // Disarm and clear before calling up, the done callback may restart the
+    // player. A persistent callback removed while it runs is cleaned up once
+    // it returns.
+    if (edge_cb_hdl) {
+        gpi_remove_cb(edge_cb_hdl);
+        edge_cb_hdl = nullptr;
+    }
+    PythonCallback *done_cb = m_done_cb;
+    m_done_cb = nullptr;
+    if (!done_cb) {
+        // LCOV_EXCL_START
+        return 0;
+        // LCOV_EXCL_STOP
+    }
+    return handle_gpi_callback(done_cb);
+}
+
+int GpiPlayer::edge() {
+    if (!m_persistent) {
+        // The fired value change callback cleans itself up after we return.
+        edge_cb_hdl = nullptr;
+    }
+
+    for (auto sig : capture) {
+        m_captured.push_back(
+            static_cast<uint32_t>(gpi_get_signal_value_long(sig)));
+    }
+    m_cycle++;
+
+    bool watch_hit =
+        m_watch_index >= 0 &&
+        (m_captured[m_captured.size() - capture.size() + m_watch_index] &
+         m_watch_mask) == m_watch_value;
+    if (watch_hit || m_cycle == m_num_cycles) {
+        return finish();
+    }
+
+    apply(m_cycle);
+    if (m_persistent) {
+        return 0;
+    }
+
+    edge_cb_hdl = gpi_register_value_change_callback(
+        &GpiPlayer::edge_cb, this, clk_signal, GPI_RISING);
+    if (!edge_cb_hdl) {
+        // LCOV_EXCL_START
+        PYGPI_LOG_ERROR(
+            "Player will be stopped: failed to register edge cb at cycle %zu",
+            m_cycle);
+        return finish();
+        // LCOV_EXCL_STOP
+    }
+
+    return 0;
+}
+
+int GpiPlayer::edge_cb(void *gpi_player) {
+    PYGPI_LOG_TRACE("GPI => [ PYGPI (GpiPlayer) ]");
+    GpiPlayer *player_obj = (GpiPlayer *)gpi_player;
+    int result = player_obj->edge();
+    PYGPI_LOG_TRACE("[ PYGPI (GpiPlayer) ] => GPI");
+    return result;
+}
+
+// Collect the signal handles of a sequence into *out*, checking that each can
+// be read through an integer of *max_width* bits
+static int collect_signals(PyObject *seq, const char *what, int max_width,
+                           std::vector<GpiObjHdl *> &out) {
+    PyObject *fast = PySequence_Fast(seq, what);  // New reference
+    if (fast == NULL) {
+        return -1;
+    }
+    DEFER(Py_DECREF(fast));
+
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(fast);
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject *item = PySequence_Fast_GET_ITEM(fast, i);  // borrow reference
+        if (Py_TYPE(item) != &gpi_hdl_Object<gpi_sim_hdl>::py_type) {
+            PyErr_Format(PyExc_TypeError, "%s must only contain gpi_sim_hdl",
+                         what);
+            return -1;
+        }
+        gpi_sim_hdl hdl = ((gpi_hdl_Object<gpi_sim_hdl> *)item)->hdl;
+
+        gpi_objtype type = gpi_get_object_type(hdl);
+        if (type != GPI_LOGIC && type != GPI_LOGIC_ARRAY &&
+            type != GPI_INTEGER && type != GPI_ENUM) {
+            PyErr_Format(PyExc_TypeError, "%s: %s is not a logic or integer",
+                         what, gpi_get_signal_name_str(hdl));
+            return -1;
+        }
+        if (gpi_get_num_elems(hdl) > max_width) {
+            PyErr_Format(PyExc_ValueError, "%s: %s is wider than %d bits",
+                         what, gpi_get_signal_name_str(hdl), max_width);
+            return -1;
+        }
+        out.push_back(hdl);
+    }
+    return 0;
+}
+
+// Create a new player object
+static PyObject *player_create(PyObject *, PyObject *args) {
+    if (!gpi_has_registered_impl()) {
+        // LCOV_EXCL_START
+        PyErr_SetString(PyExc_RuntimeError, "No simulator available!");
+        return NULL;
+        // LCOV_EXCL_STOP
+    }
+
+    PyObject *pClkHdl;
+    PyObject *pDrive;
+    PyObject *pCapture;
+    if (!PyArg_ParseTuple(args, "O!OO:player_create",
+                          &gpi_hdl_Object<gpi_sim_hdl>::py_type, &pClkHdl,
+                          &pDrive, &pCapture)) {
+        return NULL;
+    }
+    gpi_sim_hdl clk_hdl = ((gpi_hdl_Object<gpi_sim_hdl> *)pClkHdl)->hdl;
+
+    std::vector<GpiObjHdl *> drive;
+    std::vector<GpiObjHdl *> capture;
+    if (collect_signals(pDrive, "drive", 32, drive) < 0 ||
+        collect_signals(pCapture, "capture", 32, capture) < 0) {
+        return NULL;
+    }
+    if (drive.empty()) {
+        PyErr_SetString(PyExc_ValueError, "Player needs a signal to drive");
+        return NULL;
+    }
+
+    GpiPlayer *gpi_player =
+        new GpiPlayer(clk_hdl, std::move(drive), std::move(capture));
+
+    return gpi_hdl_New(gpi_player);
+}
+
+static void player_dealloc(PyObject *self) {
+    if (Py_TYPE(self) != &gpi_hdl_Object<gpi_player_hdl>::py_type) {
+        // LCOV_EXCL_START
+        PyErr_SetString(PyExc_TypeError, "Wrong type for player_dealloc!");
+        return;
+        // LCOV_EXCL_STOP
+    }
+
+    GpiPlayer *gpi_player = ((gpi_hdl_Object<gpi_player_hdl> *)self)->hdl;
+
+    delete gpi_player;
+
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *player_load(gpi_hdl_Object<gpi_player_hdl> *self,
+                             PyObject *args) {
+    Py_buffer view;
+
+    if (!PyArg_ParseTuple(args, "y*:load", &view)) {
+        return NULL;
+    }
+    DEFER(PyBuffer_Release(&view));
+
+    if (view.len % sizeof(uint32_t)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "Stimulus must be a whole number of 32-bit words");
+        return NULL;
+    }
+
+    int ret = self->hdl->load(static_cast<const uint32_t *>(view.buf),
+                              view.len / sizeof(uint32_t));
+
+    if (ret == EBUSY) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "Failed to load stimulus: player is running!\n");
+        return NULL;
+    } else if (ret != 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "Failed to load stimulus: not a whole number of "
+                        "cycles!\n");
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *player_watch(gpi_hdl_Object<gpi_player_hdl> *self,
+                              PyObject *args) {
+    int index;
+    unsigned int mask, value;
+
+    if (!PyArg_ParseTuple(args, "iII:watch", &index, &mask, &value)) {
+        return NULL;
+    }
+
+    if (self->hdl->watch(index, mask, value) != 0) {
+        PyErr_SetString(PyExc_IndexError,
+                        "Watch index is not a capture signal");
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *player_start(gpi_hdl_Object<gpi_player_hdl> *self,
+                              PyObject *args) {
+    Py_ssize_t numargs = PyTuple_Size(args);
+
+    if (numargs < 2) {
+        PyErr_SetString(
+            PyExc_TypeError,
+            "Attempt to start player without enough arguments!\n");
+        return NULL;
+    }
+
+    PyObject *pAction = PyTuple_GetItem(args, 0);  // borrow reference
+    long set_action = PyLong_AsLong(pAction);
+    if (set_action == -1 && PyErr_Occurred()) {
+        return NULL;
+    }
+
+    // Extract the callback function
+    PyObject *function = PyTuple_GetItem(args, 1);  // borrow reference
+    if (!PyCallable_Check(function)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "Attempt to start player without passing a callable "
+                        "callback!\n");
+        return NULL;
+    }
+
+    // Remaining args for function
+    PyObject *fArgs = PyTuple_GetSlice(args, 2, numargs);  // New reference
+    if (fArgs == NULL) {
+        return NULL;
+    }
+    DEFER(Py_DECREF(fArgs));
+
+    PythonCallback *cb_data = new PythonCallback(function, fArgs, NULL);
+
+    int ret = self->hdl->start((gpi_set_action)set_action, cb_data);
+
+    if (ret != 0) {
+        delete cb_data;
+        if (ret == EINVAL) {
+            PyErr_SetString(PyExc_ValueError,
+                            "Failed to start player: no stimulus loaded!\n");
+        } else if (ret == EBUSY) {
+            PyErr_SetString(PyExc_RuntimeError,
+                            "Failed to start player: already started!\n");
+        } else {
+            // LCOV_EXCL_START
+            PyErr_SetString(PyExc_RuntimeError, "Failed to start player!\n");
+            // LCOV_EXCL_STOP
+        }
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *player_stop(gpi_hdl_Object<gpi_player_hdl> *self,
+                             PyObject *) {
+    self->hdl->stop();
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *player_cycles(gpi_hdl_Object<gpi_player_hdl> *self,
+                               PyObject *) {
+    return PyLong_FromSize_t(self->hdl->cycles());
+}
+
+static PyObject *player_captured(gpi_hdl_Object<gpi_player_hdl> *self,
+                                 PyObject *) {
+    const std::vector<uint32_t> &captured = self->hdl->captured();
+    return PyBytes_FromStringAndSize(
+        reinterpret_cast<const char *>(captured.data()),
+        captured.size() * sizeof(uint32_t));
+}
+
+class GpiMonitor {
+  public:
+    // One side of the monitored channel
+    struct Port {
+        GpiObjHdl *valid;
+        GpiObjHdl *ready;
+        GpiObjHdl *data;
+
+        // Settled values at the end of the last time step, data as (aval,
+        // bval) word pairs like gpi_get_signal_value_vector()
+        bool cur_valid = false;
+        bool cur_ready = false;
+        std::vector<uint32_t> cur_data;
+
+        // Whether valid was high without ready at the last edge, and the data
+        bool stalled = false;
+        std::vector<uint32_t> stalled_data;
+
+        uint64_t beats = 0;
+        uint64_t stalls = 0;  // Edges with valid but not ready: backpressure
+        uint64_t idles = 0;   // Edges with ready but not valid: starvation
+    };
+
+    GpiMonitor(GpiObjHdl *clk_sig, Port in, Port out)
+        : clk_signal(clk_sig),
+          m_in(in),
+          m_out(out),
+          m_expected(out.cur_data.size()) {}
+
+    ~GpiMonitor() { stop(); }
+
+    // Start checking the channel on each rising edge of the clock, from the
+    // values settled at the end of the time step before it, and clear the
+    // statistics. *on_violation* is called with a message for each protocol
+    // violation. Returns nonzero in case of failure:
+    //  - EBUSY if the monitor was already started (stop first)
+    //  - EAGAIN if registering the ReadOnly callback failed
+    int start(PyObject *on_violation);
+
+    int stop();
+
+    PyObject *stats() const;
+
+  private:
+    GpiObjHdl *clk_signal = nullptr;
+    GpiCbHdl *cb_hdl = nullptr;
+    PyObject *m_on_violation = nullptr;
+    bool m_running = false;
+
+    Port m_in;
+    Port m_out;
+    int m_last_clk = -1;
+
+    // Data accepted upstream and not yet delivered downstream, as the words
+    // of each beat one after the other, and the edge each was accepted on
+    std::deque<uint32_t> m_in_flight_words;
+    std::deque<uint64_t> m_in_flight;
+    std::vector<uint32_t> m_expected;
+
+    uint64_t m_cycles = 0;
+    uint64_t m_violations = 0;
+    std::vector<uint64_t> m_occupancy;  // Edges by items in flight after them
+    std::vector<uint64_t> m_latency;    // Beats by edges from in to out
+
+    static void sample(Port &port);
+    int check(Port &port, const char *name);
+    int violation(const char *fmt, ...);
+    int edge();
+    int read_only();
+    static int read_only_cb(void *gpi_monitor);
+    static int next_time_cb(void *gpi_monitor);
+};
+
+static void histogram_add(std::vector<uint64_t> &histogram, size_t bucket) {
+    if (bucket >= histogram.size()) {
+        histogram.resize(bucket + 1);
+    }
+    histogram[bucket]++;
+}
+
+int GpiMonitor::start(PyObject *on_violation) {
+    if (m_running) {
+        return EBUSY;
+    }
+
+    cb_hdl = gpi_register_readonly_callback(&GpiMonitor::read_only_cb, this);
+    if (!cb_hdl) {
+        // LCOV_EXCL_START
+        return EAGAIN;
+        // LCOV_EXCL_STOP
+    }
+
+    Py_INCREF(on_violation);
+    m_on_violation = on_violation;
+    m_running = true;
+
+    m_last_clk = -1;
+    m_in.stalled = m_out.stalled = false;
+    m_in.beats = m_in.stalls = m_in.idles = 0;
+    m_out.beats = m_out.stalls = m_out.idles = 0;
+    m_in_flight_words.clear();
+    m_in_flight.clear();
+    m_cycles = 0;
+    m_violations = 0;
+    m_occupancy.clear();
+    m_latency.clear();
+    return 0;
+}
+
+int GpiMonitor::stop() {
+    if (!m_running) {
+        return -1;
+    }
+    // May be called from the violation callback, while no callback is pending
+    if (cb_hdl) {
+        gpi_remove_cb(cb_hdl);
+        cb_hdl = nullptr;
+    }
+    m_running = false;
+    Py_CLEAR(m_on_violation);
+    return 0;
+}
+
+void GpiMonitor::sample(Port &port) {
+    port.cur_valid = gpi_get_signal_value_long(port.valid) & 1;
+    port.cur_ready = gpi_get_signal_value_long(port.ready) & 1;
+    gpi_get_signal_value_vector(port.data, port.cur_data.data(),
+                                static_cast<int>(port.cur_data.size() / 2));
+}
+
+// Format (aval, bval) word pairs in hex, with x for digits with unknown bits
+static std::string format_data(const std::vector<uint32_t> &words) {
+    static const char digits[] = "0123456789abcdef";
+    std::string text = "0x";
+    for (size_t i = words.size(); i >= 2; i -= 2) {
+        for (int shift = 28; shift >= 0; shift -= 4) {
+            uint32_t aval = (words[i - 2] >> shift) & 0xf;
+            uint32_t bval = (words[i - 1] >> shift) & 0xf;
+            if (text.size() == 2 && !aval && !bval) {
+                continue;  // Leading zero
+            }
+            text += bval ? 'x' : digits[aval];
+        }
+    }
+    if (text.size() == 2) {
+        text += '0';
+    }
+    return text;
+}
+
+int GpiMonitor::violation(const char *fmt, ...) {
+    m_violations++;
+
+    // Wide data makes for long messages
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    std::vector<char> message(n > 0 ? n + 1 : 1);
+    va_start(args, fmt);
+    vsnprintf(message.data(), message.size(), fmt, args);
+    va_end(args);
+
+    c_to_python();
+    DEFER(python_to_c());
+
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    DEFER(PyGILState_Release(gstate));
+
+    PyObject *pArgs = Py_BuildValue("(s)", message.data());  // New reference
+    if (pArgs == NULL) {
+        // LCOV_EXCL_START
+        PyErr_Print();
+        PyErr_Clear();
+        return -1;
+        // LCOV_EXCL_STOP
+    }
+    DEFER(Py_DECREF(pArgs));
+
+    // The callback may stop the monitor, which drops its reference
+    PyObject *function = m_on_violation;
+    Py_INCREF(function);
+    DEFER(Py_DECREF(function));
+
+    return call_python_callback(function, pArgs, NULL);
+}
+
+// Check the rules for one side of the channel: once valid is high it must
+// stay high, with the same data, until ready is
+int GpiMonitor::check(Port &port, const char *name) {
+    int ret = 0;
+    if (port.stalled) {
+        if (!port.cur_valid) {
+            ret = violation("cycle %llu: %s dropped valid without a handshake",
+                            (unsigned long long)m_cycles, name);
+        } else if (port.cur_data != port.stalled_data) {
+            ret = violation(
+                "cycle %llu: %s changed data from %s to %s while stalled",
+                (unsigned long long)m_cycles, name,
+                format_data(port.stalled_data).c_str(),
+                format_data(port.cur_data).c_str());
+        }
+    }
+
+    port.stalled = port.cur_valid && !port.cur_ready;
+    port.stalled_data = port.cur_data;
+    if (port.cur_valid && port.cur_ready) {
+        port.beats++;
+    } else if (port.cur_valid) {
+        port.stalls++;
+    } else if (port.cur_ready) {
+        port.idles++;
+    }
+    return ret;
+}
+
+int GpiMonitor::edge() {
+    m_cycles++;
+
+    int ret = 0;
+    if (check(m_in, "upstream") < 0) {
+        ret = -1;
+    }
+    if (m_running && check(m_out, "downstream") < 0) {
+        ret = -1;
+    }
+
+    // Take the upstream beat first, a bypassed channel delivers it on the
+    // same edge
+    if (m_in.cur_valid && m_in.cur_ready) {
+        m_in_flight_words.insert(m_in_flight_words.end(),
+                                 m_in.cur_data.begin(), m_in.cur_data.end());
+        m_in_flight.push_back(m_cycles);
+    }
+    if (m_running && m_out.cur_valid && m_out.cur_ready) {
+        if (m_in_flight.empty()) {
+            if (violation("cycle %llu: downstream delivered %s which was "
+                          "never sent",
+                          (unsigned long long)m_cycles,
+                          format_data(m_out.cur_data).c_str()) < 0) {
+                ret = -1;
+            }
+        } else {
+            histogram_add(m_latency, m_cycles - m_in_flight.front());
+            m_in_flight.pop_front();
+
+            // Compare the values, zero-extending the narrower side
+            bool same = true;
+            for (size_t i = 0; i < m_in.cur_data.size(); i++) {
+                uint32_t word = m_in_flight_words.front();
+                m_in_flight_words.pop_front();
+                if (i < m_expected.size()) {
+                    m_expected[i] = word;
+                } else if (word) {
+                    same = false;
+                }
+            }
+            for (size_t i = m_in.cur_data.size(); i < m_expected.size(); i++) {
+                m_expected[i] = 0;
+            }
+            if ((!same || m_expected != m_out.cur_data) &&
+                violation("cycle %llu: downstream delivered %s, expected %s "
+                          "(lost, reordered or duplicated)",
+                          (unsigned long long)m_cycles,
+                          format_data(m_out.cur_data).c_str(),
+                          format_data(m_expected).c_str()) < 0) {
+                ret = -1;
+            }
+        }
+    }
+
+    histogram_add(m_occupancy, m_in_flight.size());
+    return ret;
+}
+
+int GpiMonitor::read_only() {
+    // The fired callback cleans itself up after we return.
+    cb_hdl = nullptr;
+
+    int ret = 0;
+    int clk = gpi_get_signal_value_long(clk_signal) & 1;
+    if (clk && m_last_clk == 0) {
+        ret = edge();
+    }
+    m_last_clk = clk;
+    if (!m_running) {
+        return ret;
+    }
+
+    sample(m_in);
+    sample(m_out);
+
+    cb_hdl = gpi_register_nexttime_callback(&GpiMonitor::next_time_cb, this);
+    if (!cb_hdl) {
+        // LCOV_EXCL_START
+        PYGPI_LOG_ERROR(
+            "Monitor will be stopped: failed to register next time cb");
+        stop();
+        // LCOV_EXCL_STOP
+    }
+    return ret;
+}
+
+int GpiMonitor::read_only_cb(void *gpi_monitor) {
+    PYGPI_LOG_TRACE("GPI => [ PYGPI (GpiMonitor) ]");
+    GpiMonitor *monitor_obj = (GpiMonitor *)gpi_monitor;
+    int result = monitor_obj->read_only();
+    PYGPI_LOG_TRACE("[ PYGPI (GpiMonitor) ] => GPI");
+    return result;
+}
+
+int GpiMonitor::next_time_cb(void *gpi_monitor) {
+    GpiMonitor *monitor_obj = (GpiMonitor *)gpi_monitor;
+    monitor_obj->cb_hdl = gpi_register_readonly_callback(
+        &GpiMonitor::read_only_cb, monitor_obj);
+    if (!monitor_obj->cb_hdl) {
+        // LCOV_EXCL_START
+        PYGPI_LOG_ERROR(
+            "Monitor will be stopped: failed to register ReadOnly cb");
+        monitor_obj->stop();
+        // LCOV_EXCL_STOP
+    }
+    return 0;
+}
+
+static PyObject *histogram_to_list(const std::vector<uint64_t> &histogram) {
+    PyObject *list = PyList_New(histogram.size());  // New reference
+    if (list == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < histogram.size(); i++) {
+        PyObject *count = PyLong_FromUnsignedLongLong(histogram[i]);
+        if (count == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, count);  // steals reference
+    }
+    return list;
+}
+
+PyObject *GpiMonitor::stats() const {
+    PyObject *occupancy = histogram_to_list(m_occupancy);
+    if (occupancy == NULL) {
+        return NULL;
+    }
+    PyObject *latency = histogram_to_list(m_latency);
+    if (latency == NULL) {
+        Py_DECREF(occupancy);
+        return NULL;
+    }
+    return Py_BuildValue(
+        "{s:K,s:K,s:n,s:K,s:K,s:K,s:K,s:K,s:K,s:N,s:N}", "cycles",
+        (unsigned long long)m_cycles, "violations",
+        (unsigned long long)m_violations, "in_flight",
+        (Py_ssize_t)m_in_flight.size(), "upstream_beats",
+        (unsigned long long)m_in.beats, "upstream_stalls",
+        (unsigned long long)m_in.stalls, "upstream_idles",
+        (unsigned long long)m_in.idles, "downstream_beats",
+        (unsigned long long)m_out.beats, "downstream_stalls",
+        (unsigned long long)m_out.stalls, "downstream_idles",
+        (unsigned long long)m_out.idles, "occupancy", occupancy, "latency",
+        latency);
+}
+
+// Collect a (valid, ready, data) sequence into a monitor port
+static int monitor_port(PyObject *seq, const char *what,
+                        GpiMonitor::Port &port) {
+    std::vector<GpiObjHdl *> signals;
+    if (collect_signals(seq, what, INT_MAX, signals) < 0) {
+        return -1;
+    }
+    if (signals.size() != 3) {
+        PyErr_Format(PyExc_ValueError,
+                     "%s must be a (valid, ready, data) sequence", what);
+        return -1;
+    }
+    port.valid = signals[0];
+    port.ready = signals[1];
+    port.data = signals[2];
+
+    // Data of any width is read as word pairs
+    int n_pairs = gpi_get_signal_value_vector(port.data, NULL, 0);
+    if (n_pairs < 1) {
+        PyErr_Format(PyExc_TypeError, "%s: %s can't be read as a vector", what,
+                     gpi_get_signal_name_str(port.data));
+        return -1;
+    }
+    port.cur_data.resize(2 * (size_t)n_pairs);
+    port.stalled_data.resize(2 * (size_t)n_pairs);
+    return 0;
+}
+
+// Create a new monitor object
+static PyObject *monitor_create(PyObject *, PyObject *args) {
+    if (!gpi_has_registered_impl()) {
+        // LCOV_EXCL_START
+        PyErr_SetString(PyExc_RuntimeError, "No simulator available!");
+        return NULL;
+        // LCOV_EXCL_STOP
+    }
+
+    PyObject *pClkHdl;
+    PyObject *pUpstream;
+    PyObject *pDownstream;
+    if (!PyArg_ParseTuple(args, "O!OO:monitor_create",
+                          &gpi_hdl_Object<gpi_sim_hdl>::py_type, &pClkHdl,
+                          &pUpstream, &pDownstream)) {
+        return NULL;
+    }
+    gpi_sim_hdl clk_hdl = ((gpi_hdl_Object<gpi_sim_hdl> *)pClkHdl)->hdl;
+
+    GpiMonitor::Port upstream;
+    GpiMonitor::Port downstream;
+    if (monitor_port(pUpstream, "upstream", upstream) < 0 ||
+        monitor_port(pDownstream, "downstream", downstream) < 0) {
+        return NULL;
+    }
+
+    GpiMonitor *gpi_monitor = new GpiMonitor(clk_hdl, upstream, downstream);
+
+    return gpi_hdl_New(gpi_monitor);
+}
+
+static void monitor_dealloc(PyObject *self) {
+    if (Py_TYPE(self) != &gpi_hdl_Object<gpi_monitor_hdl>::py_type) {
+        // LCOV_EXCL_START
+        PyErr_SetString(PyExc_TypeError, "Wrong type for monitor_dealloc!");
+        return;
+        // LCOV_EXCL_STOP
+    }
+
+    GpiMonitor *gpi_monitor = ((gpi_hdl_Object<gpi_monitor_hdl> *)self)->hdl;
+
+    delete gpi_monitor;
+
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *monitor_start(gpi_hdl_Object<gpi_monitor_hdl> *self,
+                               PyObject *args) {
+    PyObject *on_violation;
+
+    if (!PyArg_ParseTuple(args, "O:start", &on_violation)) {
+        return NULL;
+    }
+    if (!PyCallable_Check(on_violation)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "Attempt to start monitor without passing a callable "
+                        "callback!\n");
+        return NULL;
+    }
+
+    int ret = self->hdl->start(on_violation);
+
+    if (ret == EBUSY) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "Failed to start monitor: already started!\n");
+        return NULL;
+    } else if (ret != 0) {
+        // LCOV_EXCL_START
+        PyErr_SetString(PyExc_RuntimeError, "Failed to start monitor!\n");
+        return NULL;
+        // LCOV_EXCL_STOP
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *monitor_stop(gpi_hdl_Object<gpi_monitor_hdl> *self,
+                              PyObject *) {
+    self->hdl->stop();
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *monitor_stats(gpi_hdl_Object<gpi_monitor_hdl> *self,
+                               PyObject *) {
+    return self->hdl->stats();
+}
+
+static int add_module_constants(PyObject *simulator) {
+    // Make the GPI constants accessible from the C world
+    if (PyModule_AddIntConstant(simulator, "UNKNOWN", GPI_UNKNOWN) < 0 ||
+        PyModule_AddIntConstant(simulator, "MEMORY", GPI_MEMORY) < 0 ||
+        PyModule_AddIntConstant(simulator, "MODULE", GPI_MODULE) < 0 ||
+        PyModule_AddIntConstant(simulator, "NETARRAY", GPI_ARRAY) < 0 ||
+        PyModule_AddIntConstant(simulator, "ENUM", GPI_ENUM) < 0 ||
+        PyModule_AddIntConstant(simulator, "STRUCTURE", GPI_STRUCTURE) < 0 ||
+        PyModule_AddIntConstant(simulator, "PACKED_STRUCTURE",
+                                GPI_PACKED_STRUCTURE) < 0 ||
+        PyModule_AddIntConstant(simulator, "REAL", GPI_REAL) < 0 ||
+        PyModule_AddIntConstant(simulator, "INTEGER", GPI_INTEGER) < 0 ||
+        PyModule_AddIntConstant(simulator, "STRING", GPI_STRING) < 0 ||
+        PyModule_AddIntConstant(simulator, "GENARRAY", GPI_GENARRAY) < 0 ||
+        PyModule_AddIntConstant(simulator, "PACKAGE", GPI_PACKAGE) < 0 ||
+        PyModule_AddIntConstant(simulator, "OBJECTS", GPI_OBJECTS) < 0 ||
+        PyModule_AddIntConstant(simulator, "DRIVERS", GPI_DRIVERS) < 0 ||
+        PyModule_AddIntConstant(simulator, "LOADS", GPI_LOADS) < 0 ||
+        PyModule_AddIntConstant(simulator, "RISING", GPI_RISING) < 0 ||
+        PyModule_AddIntConstant(simulator, "FALLING", GPI_FALLING) < 0 ||
+        PyModule_AddIntConstant(simulator, "VALUE_CHANGE", GPI_VALUE_CHANGE) <
+            0 ||
+        PyModule_AddIntConstant(simulator, "RANGE_UP", GPI_RANGE_UP) < 0 ||
+        PyModule_AddIntConstant(simulator, "RANGE_DOWN", GPI_RANGE_DOWN) < 0 ||
+        PyModule_AddIntConstant(simulator, "RANGE_NO_DIR", GPI_RANGE_NO_DIR) <
+            0 ||
+        PyModule_AddIntConstant(simulator, "LOGIC", GPI_LOGIC) < 0 ||
+        PyModule_AddIntConstant(simulator, "LOGIC_ARRAY", GPI_LOGIC_ARRAY) <
+            0 ||
+        false) {
+        return -1;
+    }
+
+    return 0;
+}
+
+// Add the extension types as entries in the module namespace
+static int add_module_types(PyObject *simulator) {
+    PyObject *typ;
+
+    typ = (PyObject *)&gpi_hdl_Object<gpi_sim_hdl>::py_type;
+    Py_INCREF(typ);
+    if (PyModule_AddObject(simulator, "gpi_sim_hdl", typ) < 0) {
+        Py_DECREF(typ);
+        return -1;
+    }
+
+    typ = (PyObject *)&gpi_hdl_Object<gpi_cb_hdl>::py_type;
+    Py_INCREF(typ);
+    if (PyModule_AddObject(simulator, "gpi_cb_hdl", typ) < 0) {
+        Py_DECREF(typ);
+        return -1;
+    }
+
+    typ = (PyObject *)&gpi_hdl_Object<gpi_iterator_hdl>::py_type;
+    Py_INCREF(typ);
+    if (PyModule_AddObject(simulator, "gpi_iterator_hdl", typ) < 0) {
+        Py_DECREF(typ);
+        return -1;
+    }
+
+    typ = (PyObject *)&gpi_hdl_Object<gpi_clk_hdl>::py_type;
+    Py_INCREF(typ);
+    if (PyModule_AddObject(simulator, "GpiClock", typ) < 0) {
+        // LCOV_EXCL_START
+        Py_DECREF(typ);
+        return -1;
+        // LCOV_EXCL_STOP
+    }
+
+    typ = (PyObject *)&gpi_hdl_Object<gpi_player_hdl>::py_type;
+    Py_INCREF(typ);
+    if (PyModule_AddObject(simulator, "GpiPlayer", typ) < 0) {
+        // LCOV_EXCL_START
+        Py_DECREF(typ);
+        return -1;
+        // LCOV_EXCL_STOP
+    }
+
+    typ = (PyObject *)&gpi_hdl_Object<gpi_monitor_hdl>::py_type;
+    Py_INCREF(typ);
+    if (PyModule_AddObject(simulator, "GpiMonitor", typ) < 0) {
+        // LCOV_EXCL_START
+        Py_DECREF(typ);
+        return -1;
+        // LCOV_EXCL_STOP
+    }
+
+    return 0;
+}
+
+/* NOTE: in the following docstrings we are specifying the parameters twice, but
+ * this is necessary. The first docstring before the long '--' line specifies
+ * the __text_signature__ that is used by the help() function. And the second
+ * after the '--' line contains type annotations used by the
+ * `autodoc_docstring_signature` setting of sphinx.ext.autodoc for generating
  * documentation because type annotations are not supported in
  * __text_signature__.
  */
@@ -1091,6 +2295,18 @@ static PyMethodDef SimulatorMethods[] = {
                "cocotb.simulator.gpi_sim_hdl, func: Callable[..., Any], edge: "
                "int, *args: Any) -> cocotb.simulator.gpi_cb_hdl\n"
                "Register a signal change callback.")},
+    {"register_persistent_value_change_callback",
+     register_persistent_value_change_callback, METH_VARARGS,
+     PyDoc_STR("register_persistent_value_change_callback(signal, func, edge, "
+               "/, *args)\n"
+               "--\n\n"
+               "register_persistent_value_change_callback(signal: "
+               "cocotb.simulator.gpi_sim_hdl, func: Callable[..., Any], edge: "
+               "int, *args: Any) -> cocotb.simulator.gpi_cb_hdl | None\n"
+               "Register a signal change callback that is called on every "
+               "change until it is deregistered.\n\n"
+               "Returns ``None`` if the simulator interface does not support "
+               "persistent callbacks.")},
     {"register_readonly_callback", register_readonly_callback, METH_VARARGS,
      PyDoc_STR("register_readonly_callback(func, /, *args)\n"
                "--\n\n"
@@ -1115,6 +2331,62 @@ static PyMethodDef SimulatorMethods[] = {
                "stop_simulator() -> None\n"
                "Instruct the attached simulator to stop. Users should not call "
                "this function.")},
+    {"request_checkpoint", request_checkpoint, METH_VARARGS,
+     PyDoc_STR("request_checkpoint(n_children, /)\n"
+               "--\n\n"
+               "request_checkpoint(n_children: int) -> None\n"
+               "Fork *n_children* copies of the simulation at the end of the "
+               "current time step. The parent waits for all of them to finish "
+               "before the next time step.")},
+    {"get_checkpoint_index", get_checkpoint_index, METH_NOARGS,
+     PyDoc_STR("get_checkpoint_index()\n"
+               "--\n\n"
+               "get_checkpoint_index() -> int\n"
+               "Get the index of this process among those forked at the last "
+               "checkpoint: ``0`` in the original process, ``1`` to "
+               "*n_children* in the children, or ``-1`` if forking failed.")},
+    {"trace_set_window", trace_set_window, METH_VARARGS,
+     PyDoc_STR("trace_set_window(start, stop, /)\n"
+               "--\n\n"
+               "trace_set_window(start: int, stop: int) -> None\n"
+               "Only trace the time steps from *start* up to, but not "
+               "including, *stop*, in simulator steps.")},
+    {"trace_set_trigger", trace_set_trigger, METH_VARARGS,
+     PyDoc_STR("trace_set_trigger(signals, values, /)\n"
+               "--\n\n"
+               "trace_set_trigger(signals: Sequence[cocotb.simulator.gpi_sim_hdl], "
+               "values: Sequence[int]) -> None\n"
+               "Only trace the time steps at the end of which every signal in "
+               "*signals* has its value in *values*. Empty sequences trace "
+               "every time step again.")},
+    {"trace_set_ring", trace_set_ring, METH_VARARGS,
+     PyDoc_STR("trace_set_ring(steps, /)\n"
+               "--\n\n"
+               "trace_set_ring(steps: int) -> None\n"
+               "Keep the trace in memory from now on, holding at least the "
+               "last *steps* traced time steps, and up to twice as many, "
+               "until saved with :func:`trace_save_ring`. A *steps* of 0 "
+               "turns the ring off.")},
+    {"trace_save_ring", trace_save_ring, METH_NOARGS,
+     PyDoc_STR("trace_save_ring()\n"
+               "--\n\n"
+               "trace_save_ring() -> None\n"
+               "Write the trace ring out to a new file at the end of the "
+               "current time step.")},
+    {"get_profile", get_profile, METH_NOARGS,
+     PyDoc_STR("get_profile()\n"
+               "--\n\n"
+               "get_profile() -> Dict[str, int]\n"
+               "Get the simulation profile counters, which are only collected "
+               "when the ``GPI_PROFILE`` environment variable is set. Counters "
+               "ending in ``.ticks`` count time, see "
+               ":func:`get_profile_tick_rate`.")},
+    {"get_profile_tick_rate", get_profile_tick_rate, METH_NOARGS,
+     PyDoc_STR("get_profile_tick_rate()\n"
+               "--\n\n"
+               "get_profile_tick_rate() -> float\n"
+               "Get the number of profile ticks per second, or ``0.0`` if "
+               "profiling is disabled.")},
     {"set_gpi_log_level", set_gpi_log_level, METH_VARARGS,
      PyDoc_STR("set_gpi_log_level(level, /)\n"
                "--\n\n"
@@ -1161,6 +2433,25 @@ static PyMethodDef SimulatorMethods[] = {
                "Create a clock driver on a signal.\n"
                "\n"
                ".. versionadded:: 2.0")},
+    {"player_create", player_create, METH_VARARGS,
+     PyDoc_STR("player_create(clock, drive, capture, /)\n"
+               "--\n\n"
+               "player_create(clock: cocotb.simulator.gpi_sim_hdl, "
+               "drive: Sequence[cocotb.simulator.gpi_sim_hdl], "
+               "capture: Sequence[cocotb.simulator.gpi_sim_hdl]"
+               ") -> cocotb.simulator.GpiPlayer\n"
+               "Create a stimulus player clocked by *clock*, driving the "
+               "*drive* signals and sampling the *capture* signals.")},
+    {"monitor_create", monitor_create, METH_VARARGS,
+     PyDoc_STR("monitor_create(clock, upstream, downstream, /)\n"
+               "--\n\n"
+               "monitor_create(clock: cocotb.simulator.gpi_sim_hdl, "
+               "upstream: Sequence[cocotb.simulator.gpi_sim_hdl], "
+               "downstream: Sequence[cocotb.simulator.gpi_sim_hdl]"
+               ") -> cocotb.simulator.GpiMonitor\n"
+               "Create a monitor for a valid/ready channel clocked by *clock*, "
+               "with *upstream* and *downstream* each a ``(valid, ready, "
+               "data)`` sequence of signals.")},
     {"initialize_logger", initialize_logger, METH_VARARGS,
      PyDoc_STR("initialize_logger(log_func, /)\n"
                "--\n\n"
@@ -1211,6 +2502,16 @@ PyMODINIT_FUNC PyInit_simulator(void) {
         return NULL;
         // LCOV_EXCL_STOP
     }
+    if (PyType_Ready(&gpi_hdl_Object<gpi_player_hdl>::py_type) < 0) {
+        // LCOV_EXCL_START
+        return NULL;
+        // LCOV_EXCL_STOP
+    }
+    if (PyType_Ready(&gpi_hdl_Object<gpi_monitor_hdl>::py_type) < 0) {
+        // LCOV_EXCL_START
+        return NULL;
+        // LCOV_EXCL_STOP
+    }
 
     PyObject *simulator = PyModule_Create(&moduledef);
     if (simulator == NULL) {
@@ -1256,6 +2557,16 @@ static PyMethodDef gpi_sim_hdl_methods[] = {
                "get_signal_val_binstr() -> str\n"
                "Get the value of a logic vector signal as a string of (``0``, "
                "``1``, ``X``, etc.), one element per character.")},
+    {"get_signal_val_vector", (PyCFunction)get_signal_val_vector,
+     METH_VARARGS,
+     PyDoc_STR("get_signal_val_vector($self, buffer, /)\n"
+               "--\n\n"
+               "get_signal_val_vector(buffer: Buffer) -> int\n"
+               "Copy the value of a logic vector signal into the writable "
+               "*buffer* as native-endian 32-bit (``aval``, ``bval``) word "
+               "pairs, least significant pair first, as in ``s_vpi_vecval``. "
+               "Returns the number of pairs the whole value needs; only as "
+               "many as fit are written.")},
     {"get_signal_val_real", (PyCFunction)get_signal_val_real, METH_NOARGS,
      PyDoc_STR("get_signal_val_real($self)\n"
                "--\n\n"
@@ -1277,6 +2588,14 @@ static PyMethodDef gpi_sim_hdl_methods[] = {
                "set_signal_val_binstr(action: int, value: str) -> None\n"
                "Set the value of a logic vector signal using a string of "
                "(``0``, ``1``, ``X``, etc.), one element per character.")},
+    {"set_signal_val_vector", (PyCFunction)set_signal_val_vector,
+     METH_VARARGS,
+     PyDoc_STR("set_signal_val_vector($self, action, value, /)\n"
+               "--\n\n"
+               "set_signal_val_vector(action: int, value: Buffer) -> None\n"
+               "Set the value of a logic vector signal from native-endian "
+               "32-bit (``aval``, ``bval``) word pairs, least significant pair "
+               "first, as in ``s_vpi_vecval``.")},
     {"set_signal_val_real", (PyCFunction)set_signal_val_real, METH_VARARGS,
      PyDoc_STR("set_signal_val_real($self, action, value, /)\n"
                "--\n\n"
@@ -1308,6 +2627,15 @@ static PyMethodDef gpi_sim_hdl_methods[] = {
          "--\n\n"
          "get_handle_by_index(index: int) -> cocotb.simulator.gpi_sim_hdl\n"
          "Get a handle to a child object by index.")},
+    {"discover_scope", (PyCFunction)discover_scope, METH_VARARGS,
+     PyDoc_STR("discover_scope($self, depth=-1, /)\n"
+               "--\n\n"
+               "discover_scope(depth: int = -1) -> int\n"
+               "Discover all objects below this scope in one walk of the "
+               "hierarchy, so later lookups of them by name don't go to the "
+               "simulator. *depth* limits how many levels of nested scopes are "
+               "walked; ``-1`` walks them all. Returns the number of objects "
+               "discovered.")},
     {"get_name_string", (PyCFunction)get_name_string, METH_NOARGS,
      PyDoc_STR("get_name_string($self)\n"
                "--\n\n"
@@ -1437,3 +2765,108 @@ PyTypeObject gpi_hdl_Object<gpi_clk_hdl>::py_type = []() -> PyTypeObject {
     type.tp_dealloc = clock_dealloc;
     return type;
 }();
+
+static PyMethodDef gpi_player_methods[] = {
+    {"load", (PyCFunction)player_load, METH_VARARGS,
+     PyDoc_STR(
+         "load($self, stimulus, /)\n"
+         "--\n\n"
+         "load(stimulus: Buffer) -> None\n"
+         "Load the stimulus to play.\n"
+         "\n"
+         "*stimulus* is a buffer of native-endian 32-bit words, one per drive "
+         "signal per cycle, cycle-major (e.g. a ``numpy.uint32`` array of "
+         "shape ``(cycles, len(drive))``).\n"
+         "\n"
+         "Raises:\n"
+         "    ValueError: If the buffer is not a whole number of cycles.\n"
+         "    RuntimeError: If the player is running.")},
+    {"watch", (PyCFunction)player_watch, METH_VARARGS,
+     PyDoc_STR("watch($self, index, mask, value, /)\n"
+               "--\n\n"
+               "watch(index: int, mask: int, value: int) -> None\n"
+               "Stop early once ``capture[index] & mask == value`` after an "
+               "edge. A negative *index* disables the watch.")},
+    {"start", (PyCFunction)player_start, METH_VARARGS,
+     PyDoc_STR(
+         "start($self, set_action, func, /, *args)\n"
+         "--\n\n"
+         "start(set_action: int, func: Callable[..., Any], *args: Any) -> "
+         "None\n"
+         "Apply the first cycle of stimulus now and one more per rising edge "
+         "of the clock, sampling the capture signals after each edge. "
+         "*func* is called once when the stimulus is exhausted or the watch "
+         "fires.\n"
+         "\n"
+         "Raises:\n"
+         "    ValueError: If no stimulus is loaded.\n"
+         "    RuntimeError: If the player was already started, or the "
+         "GPI callback could not be registered.")},
+    {"stop", (PyCFunction)player_stop, METH_NOARGS,
+     PyDoc_STR("stop($self)\n"
+               "--\n\n"
+               "stop() -> None\n"
+               "Stop this player now without calling its callback.")},
+    {"cycles", (PyCFunction)player_cycles, METH_NOARGS,
+     PyDoc_STR("cycles($self)\n"
+               "--\n\n"
+               "cycles() -> int\n"
+               "Get the number of cycles played since the last start.")},
+    {"captured", (PyCFunction)player_captured, METH_NOARGS,
+     PyDoc_STR("captured($self)\n"
+               "--\n\n"
+               "captured() -> bytes\n"
+               "Get the values sampled since the last start, as native-endian "
+               "32-bit words, one per capture signal per cycle.")},
+    {NULL, NULL, 0, NULL} /* Sentinel */
+};
+
+template <>
+PyTypeObject gpi_hdl_Object<gpi_player_hdl>::py_type = []() -> PyTypeObject {
+    auto type = fill_common_slots<gpi_player_hdl>();
+    type.tp_name = "cocotb.simulator.GpiPlayer";
+    type.tp_doc = "C++ stimulus player using the GPI.";
+    type.tp_methods = gpi_player_methods;
+    type.tp_dealloc = player_dealloc;
+    return type;
+}();
+
+static PyMethodDef gpi_monitor_methods[] = {
+    {"start", (PyCFunction)monitor_start, METH_VARARGS,
+     PyDoc_STR(
+         "start($self, on_violation, /)\n"
+         "--\n\n"
+         "start(on_violation: Callable[[str], Any]) -> None\n"
+         "Clear the statistics and check the channel on each rising edge of "
+         "the clock from now on. *on_violation* is called with a message for "
+         "each protocol violation.\n"
+         "\n"
+         "Raises:\n"
+         "    RuntimeError: If the monitor was already started, or the "
+         "GPI callback could not be registered.")},
+    {"stop", (PyCFunction)monitor_stop, METH_NOARGS,
+     PyDoc_STR("stop($self)\n"
+               "--\n\n"
+               "stop() -> None\n"
+               "Stop this monitor now, keeping its statistics.")},
+    {"stats", (PyCFunction)monitor_stats, METH_NOARGS,
+     PyDoc_STR("stats($self)\n"
+               "--\n\n"
+               "stats() -> Dict[str, Any]\n"
+               "Get the statistics since the last start: counts of edges, "
+               "violations, beats in flight, and beats, stalls and idle "
+               "edges on each side, and the ``occupancy`` and ``latency`` "
+               "histograms as lists indexed by beats in flight and by edges "
+               "from upstream to downstream.")},
+    {NULL, NULL, 0, NULL} /* Sentinel */
+};
+
+template <>
+PyTypeObject gpi_hdl_Object<gpi_monitor_hdl>::py_type = []() -> PyTypeObject {
+    auto type = fill_common_slots<gpi_monitor_hdl>();
+    type.tp_name = "cocotb.simulator.GpiMonitor";
+    type.tp_doc = "C++ valid/ready channel monitor using the GPI.";
+    type.tp_methods = gpi_monitor_methods;
+    type.tp_dealloc = monitor_dealloc;
+    return type;
+}();
@@ -185,6 +185,7 @@ void py_gpi_logger_initialize(PyObject *log_func, PyObject *get_logger) {
 }
 
 void py_gpi_logger_finalize() {
+    gpi_log_flush();
     gpi_clear_log_handler();
     Py_XDECREF(m_log_func);
     Py_XDECREF(m_get_logger);
@@ -22,8 +22,13 @@ extern int pygpi_debug_enabled;
 extern int python_context_tracing_enabled;
 extern int is_python_context;
 
-#define PYGPI_LOG_(level, ...) \
-    gpi_log_("pygpi", level, __FILE__, __func__, __LINE__, __VA_ARGS__)
+#define PYGPI_LOG_(level, ...)                                     \
+    do {                                                           \
+        if ((level) >= GPI_LOG_MIN_LEVEL) {                        \
+            gpi_log_("pygpi", level, __FILE__, __func__, __LINE__, \
+                     __VA_ARGS__);                                 \
+        }                                                          \
+    } while (0)
 
 /** Logs a message at TRACE log level if PYGPI tracing is enabled */
 #define PYGPI_LOG_TRACE(...)                    \
@@ -7,6 +7,16 @@
 #ifndef COCOTB_UTILS_H_
 #define COCOTB_UTILS_H_
 
+#include <cstddef>  // std::size_t
+#include <cstdint>  // uint64_t
+#include <new>      // ::operator new
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>  // __rdtsc
+#else
+#include <chrono>  // std::chrono::steady_clock
+#endif
+
 #define xstr(a) str(a)
 #define str(a) #a
 
@@ -30,4 +40,97 @@ constexpr Deferable<F> make_deferable(F f) {
 #define DEFER(statement) \
     auto DEFER0(_defer, __COUNTER__) = make_deferable([&]() { statement; });
 
+/** Mixin which recycles the memory of a class's objects through a free list.
+ *
+ * For small objects created and destroyed on every simulator callback, such as
+ * callback handles. Memory is carved from slabs of SlabSize objects and is
+ * never given back to the heap. Like the rest of the GPI, it isn't
+ * thread-safe.
+ *
+ * Use as `class Foo : public Base, public Pooled<Foo>`. Subclasses of Foo
+ * which don't mix in a pool of their own fall back to the heap.
+ */
+template <typename T, std::size_t SlabSize = 64>
+class Pooled {
+  public:
+    static void *operator new(std::size_t size) {
+        if (size != sizeof(T)) {
+            return ::operator new(size);
+        }
+        if (!free_list) {
+            grow();
+        }
+        FreeNode *node = free_list;
+        free_list = node->next;
+        return node;
+    }
+
+    static void operator delete(void *ptr, std::size_t size) noexcept {
+        if (!ptr) {
+            return;
+        }
+        if (size != sizeof(T)) {
+            ::operator delete(ptr);
+            return;
+        }
+        FreeNode *node = static_cast<FreeNode *>(ptr);
+        node->next = free_list;
+        free_list = node;
+    }
+
+  private:
+    struct FreeNode {
+        FreeNode *next;
+    };
+
+    static void grow() {
+        static_assert(sizeof(T) >= sizeof(FreeNode),
+                      "Pooled objects must fit a free list pointer");
+        auto slab =
+            static_cast<unsigned char *>(::operator new(SlabSize * sizeof(T)));
+        for (std::size_t i = 0; i < SlabSize; i++) {
+            FreeNode *node = reinterpret_cast<FreeNode *>(slab + i * sizeof(T));
+            node->next = free_list;
+            free_list = node;
+        }
+    }
+
+    static FreeNode *free_list;
+};
+
+template <typename T, std::size_t SlabSize>
+typename Pooled<T, SlabSize>::FreeNode *Pooled<T, SlabSize>::free_list =
+    nullptr;
+
+/** Read the clock used by the GPI profile counters.
+ *
+ * This is the time stamp counter where there is one, since it is much cheaper
+ * to read than the system clock; see gpi_get_profile_tick_rate().
+ */
+inline uint64_t profile_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+/** Add the ticks spent in a scope to a profile counter, unless it is NULL. */
+class ProfileScope {
+  public:
+    explicit ProfileScope(uint64_t *counter)
+        : m_counter(counter), m_start(counter ? profile_ticks() : 0) {}
+    ~ProfileScope() {
+        if (m_counter) {
+            *m_counter += profile_ticks() - m_start;
+        }
+    }
+
+  private:
+    uint64_t *m_counter;
+    uint64_t m_start;
+};
+
 #endif /* COCOTB_UTILS_H_ */
@@ -2,16 +2,27 @@
 // Licensed under the Revised BSD License, see LICENSE for details.
 // SPDX-License-Identifier: BSD-3-Clause
 
-#include <libgen.h>  // basename
-#include <stdio.h>   // stderr, fprintf
+#include <errno.h>     // errno
+#include <fcntl.h>     // open
+#include <libgen.h>    // basename
+#include <stdio.h>     // stderr, fprintf
+#include <sys/wait.h>  // waitpid
+#include <unistd.h>    // fork, write
 
-#include <memory>  // std::unique_ptr
-#include <string>  // std::string
+#include <condition_variable>  // std::condition_variable
+#include <deque>               // std::deque
+#include <memory>              // std::unique_ptr
+#include <mutex>               // std::mutex
+#include <string>              // std::string
+#include <thread>              // std::thread
+#include <vector>              // std::vector
 
 #include "Vtop.h"
 #include "verilated.h"
 #include "verilated_vpi.h"
 
+#include "../utils.hpp"  // ProfileScope
+
 #ifndef VM_TRACE_FST
 // emulate new verilator behavior for legacy versions
 #define VM_TRACE_FST 0
@@ -26,10 +37,14 @@ using verilated_trace_t = VerilatedFstC;
 using verilated_trace_t = VerilatedVcdC;
 #endif
 static verilated_trace_t *tfp;
+static std::string trace_name;  // Base name for saved trace rings
 #endif
 
 static vluint64_t main_time = 0;  // Current simulation time
 
+// 0 in the original process, 1..n in children forked at a checkpoint
+static int fork_index = 0;
+
 double sc_time_stamp() {  // Called by $time in Verilog
     return main_time;     // converts to double, to match
                           // what SystemC does
@@ -37,9 +52,277 @@ double sc_time_stamp() {  // Called by $time in Verilog
 
 extern "C" {
 void vlog_startup_routines_bootstrap(void);
+void vlog_checkpoint_enable(void);
+int vlog_checkpoint_take_request(void);
+void vlog_checkpoint_forked(int index);
+void vlog_trace_control_enable(int ring);
+int vlog_trace_active(uint64_t time);
+int vlog_trace_ring(void);
+int vlog_trace_take_save_request(void);
+uint64_t *vlog_profile_counter(const char *name);
+void vlog_profile_write(const char *filename);
+}
+
+// Profile counters in the GPI, all NULL unless GPI_PROFILE is set
+static struct {
+    uint64_t *time_steps;
+    uint64_t *eval_iterations;
+    uint64_t *value_cb_reruns;
+    uint64_t *eval_ticks;
+    uint64_t *value_cb_ticks;
+    uint64_t *read_write_ticks;
+    uint64_t *read_only_ticks;
+    uint64_t *trace_ticks;
+    uint64_t *next_sim_time_ticks;
+    uint64_t *timed_ticks;
+} profile;
+
+static inline void profile_count(uint64_t *counter) {
+    if (counter) {
+        ++*counter;
+    }
+}
+
+static void profile_init() {
+    profile.time_steps = vlog_profile_counter("harness.time_steps");
+    profile.eval_iterations = vlog_profile_counter("harness.eval.iterations");
+    profile.value_cb_reruns = vlog_profile_counter("harness.value_cbs.reruns");
+    profile.eval_ticks = vlog_profile_counter("harness.eval.ticks");
+    profile.value_cb_ticks = vlog_profile_counter("harness.value_cbs.ticks");
+    profile.read_write_ticks = vlog_profile_counter("harness.read_write.ticks");
+    profile.read_only_ticks = vlog_profile_counter("harness.read_only.ticks");
+    profile.trace_ticks = vlog_profile_counter("harness.trace.ticks");
+    profile.next_sim_time_ticks =
+        vlog_profile_counter("harness.next_sim_time.ticks");
+    profile.timed_ticks = vlog_profile_counter("harness.timed.ticks");
 }
 
+// Name extra output files like "dump.fork3.vcd"
+static std::string tag_file_name(const std::string &name,
+                                 const std::string &tag) {
+    size_t dot = name.rfind('.');
+    size_t slash = name.rfind('/');
+    if (dot == std::string::npos ||
+        (slash != std::string::npos && dot < slash)) {
+        return name + tag;
+    }
+    return std::string(name).insert(dot, tag);
+}
+
+// Name the per-child output files like "dump.fork3.vcd"
+static std::string fork_file_name(const std::string &name, int index) {
+    return tag_file_name(name, ".fork" + std::to_string(index));
+}
+
+#if VM_TRACE && !VM_TRACE_FST
+// Writes the VCD from a background thread, so the simulation thread only pays
+// for encoding it.
+//
+// Once the ring is started the trace is kept in memory instead, in two
+// segments which each start with a full dump: rotating the ring drops the
+// older segment. Saving the ring writes the header and both segments to a new
+// file, which is valid since VerilatedVcd makes segments to be concatenated.
+// Turning the ring off starts one more segment, written to the trace file.
+// (FST traces are written by the FST library, which has its own writer thread
+// with --trace-threads 2.)
+class TraceWriter final : public VerilatedVcdFile {
+  public:
+    ~TraceWriter() override { close(); }
+
+    bool open(const std::string &name) override {
+        if (m_rotating) {
+            return true;
+        }
+        m_fd = ::open(name.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0666);
+        if (m_fd < 0) {
+            return false;
+        }
+        m_header.clear();
+        m_header_done = false;
+        resume();
+        return true;
+    }
+
+    void close() override {
+        if (m_rotating) {
+            m_previous.swap(m_current);
+            m_current.clear();
+            return;
+        }
+        pause();
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    ssize_t write(const char *bufp, ssize_t len) override {
+        if (!m_header_done) {
+            m_header.append(bufp, len);
+            size_t end = m_header.find("$enddefinitions $end\n");
+            if (end != std::string::npos) {
+                m_header.resize(end + sizeof("$enddefinitions $end\n") - 1);
+                m_header_done = true;
+            }
+        }
+        if (m_ring) {
+            m_current.append(bufp, len);
+        } else {
+            push("", std::string(bufp, len));
+        }
+        return len;
+    }
+
+    // Write everything queued and stop the thread, e.g. before forking
+    void pause() {
+        if (!m_thread.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_one();
+        m_thread.join();
+        m_stop = false;
+    }
+
+    void resume() {
+        if (!m_thread.joinable()) {
+            m_thread = std::thread(&TraceWriter::run, this);
+        }
+    }
+
+    bool ring_started() const { return m_ring; }
+
+    // Write the trace file to *name* from now on, starting it with the
+    // header, while the ring keeps its segments in memory. Used by forked
+    // children, which must not write to the file shared with the parent.
+    void reopen(const std::string &name) {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+        m_fd = ::open(name.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0666);
+        if (m_fd < 0) {
+            fprintf(stderr, "Error: could not open trace file %s\n",
+                    name.c_str());
+        }
+        resume();
+        push("", m_header);
+    }
+
+    // Start a new ring segment, the first time starting the ring, or stop the
+    // ring. The caller must flush the trace first, then open the next trace
+    // segment.
+    void begin_rotate(bool ring) {
+        m_ring = ring;
+        m_rotating = true;
+    }
+    void end_rotate() {
+        m_rotating = false;
+        if (!m_ring) {
+            m_previous.clear();
+            m_current.clear();
+        }
+    }
+
+    void save_ring(const std::string &name) {
+        push(name, m_header + m_previous + m_current);
+    }
+
+  private:
+    struct Chunk {
+        std::string file;  // Empty for the trace file
+        std::string data;
+    };
+
+    // Chunks queued before the simulation waits for the writer, so a trace
+    // encoded faster than it can be written doesn't take all the memory
+    static const size_t max_queued = 64;
+
+    void push(std::string file, std::string data) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            // Nothing drains the queue while paused
+            if (m_thread.joinable()) {
+                m_space.wait(lock,
+                             [this] { return m_queue.size() < max_queued; });
+            }
+            m_queue.push_back(Chunk{std::move(file), std::move(data)});
+        }
+        m_cond.notify_one();
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_cond.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                return;
+            }
+            Chunk chunk = std::move(m_queue.front());
+            m_queue.pop_front();
+            lock.unlock();
+            m_space.notify_one();
+            if (chunk.file.empty()) {
+                if (m_fd >= 0) {  // Already reported if it failed to open
+                    write_all(m_fd, chunk.data);
+                }
+            } else {
+                int fd = ::open(chunk.file.c_str(),
+                                O_CREAT | O_WRONLY | O_TRUNC, 0666);
+                if (fd < 0) {
+                    fprintf(stderr, "Error: could not save trace ring to %s\n",
+                            chunk.file.c_str());
+                } else {
+                    write_all(fd, chunk.data);
+                    ::close(fd);
+                }
+            }
+            lock.lock();
+        }
+    }
+
+    static void write_all(int fd, const std::string &data) {
+        const char *p = data.data();
+        size_t left = data.size();
+        while (left > 0) {
+            ssize_t n = ::write(fd, p, left);
+            if (n < 0) {
+                if (errno == EINTR || errno == EAGAIN) {
+                    continue;
+                }
+                perror("Error: trace write failed");  // LCOV_EXCL_LINE
+                return;                               // LCOV_EXCL_LINE
+            }
+            p += n;
+            left -= n;
+        }
+    }
+
+    int m_fd = -1;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;   // Signals chunks queued or stopping
+    std::condition_variable m_space;  // Signals room in the queue
+    std::deque<Chunk> m_queue;
+    bool m_stop = false;
+
+    std::string m_header;
+    bool m_header_done = false;
+    bool m_ring = false;
+    bool m_rotating = false;
+    std::string m_previous;
+    std::string m_current;
+};
+
+static TraceWriter *trace_writer;
+static int ring_steps = 0;  // Time steps traced in the current ring segment
+static int ring_saves = 0;
+#endif
+
 static inline bool settle_value_callbacks() {
+    ProfileScope scope(profile.value_cb_ticks);
     bool cbs_called, again;
 
     // Call Value Change callbacks
@@ -47,12 +330,132 @@ static inline bool settle_value_callbacks() {
     // until there are no more changes
     cbs_called = again = VerilatedVpi::callValueCbs();
     while (again) {
+        profile_count(profile.value_cb_reruns);
         again = VerilatedVpi::callValueCbs();
     }
 
     return cbs_called;
 }
 
+#if VM_TRACE
+// Trace the time step just completed, if it is in the trace window and the
+// trace trigger holds
+static void dump_trace(bool flush) {
+    if (vlog_trace_active(main_time)) {
+#if !VM_TRACE_FST
+        int ring = vlog_trace_ring();
+        if (ring && (!trace_writer->ring_started() || ring_steps >= ring)) {
+            tfp->flush();
+            trace_writer->begin_rotate(true);
+            tfp->openNext(false);
+            trace_writer->end_rotate();
+            ring_steps = 0;
+        }
+        ring_steps++;
+#endif
+        tfp->dump(main_time);
+        if (flush) {
+            tfp->flush();
+        }
+    }
+
+#if !VM_TRACE_FST
+    if (vlog_trace_take_save_request()) {
+        tfp->flush();
+        trace_writer->save_ring(
+            tag_file_name(trace_name, ".ring" + std::to_string(++ring_saves)));
+    }
+
+    // Go back to the trace file once the ring is turned off, after any last
+    // save
+    if (!vlog_trace_ring() && trace_writer->ring_started()) {
+        tfp->flush();
+        trace_writer->begin_rotate(false);
+        tfp->openNext(false);
+        trace_writer->end_rotate();
+    }
+#endif
+}
+#endif
+
+// Fork n_children copies of the simulation from the end of the current time
+// step. Each child carries on simulating with its own trace and coverage
+// files; the parent waits for all of them before it carries on, so its state
+// is untouched and it can take further checkpoints.
+static void fork_checkpoint(const char *traceFile, int n_children) {
+    if (Verilated::threadContextp()->threads() > 1) {
+        fprintf(stderr,
+                "Error: checkpoints require a single-threaded model "
+                "(--threads 1)\n");
+        vlog_checkpoint_forked(-1);
+        return;
+    }
+
+#if VM_TRACE
+    if (tfp) {
+        tfp->flush();
+#if !VM_TRACE_FST
+        trace_writer->pause();
+#endif
+    }
+#endif
+    // Don't let the children repeat output buffered before the fork
+    fflush(stdout);
+    fflush(stderr);
+
+    std::vector<pid_t> children;
+    for (int i = 1; i <= n_children; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            fork_index = i;
+#if VM_TRACE
+            if (tfp) {
+                trace_name = fork_file_name(traceFile, i);
+#if !VM_TRACE_FST
+                // Keep a running ring in memory, as reopening the trace would
+                // start a new segment in it
+                if (trace_writer->ring_started()) {
+                    trace_writer->reopen(trace_name);
+                } else
+#endif
+                {
+                    tfp->close();
+                    tfp->open(trace_name.c_str());
+                }
+            }
+#else
+            (void)traceFile;
+#endif
+            vlog_checkpoint_forked(i);
+            return;
+        }
+        // LCOV_EXCL_START
+        if (pid < 0) {
+            perror("Error: checkpoint fork failed");
+            break;
+        }
+        // LCOV_EXCL_STOP
+        children.push_back(pid);
+    }
+#if VM_TRACE && !VM_TRACE_FST
+    if (tfp) {
+        trace_writer->resume();
+    }
+#endif
+
+    bool ok = static_cast<int>(children.size()) == n_children;
+    for (size_t i = 0; i < children.size(); i++) {
+        int status;
+        if (waitpid(children[i], &status, 0) < 0 || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "Error: forked simulation %zu did not exit cleanly\n",
+                    i + 1);
+            ok = false;
+        }
+    }
+    vlog_checkpoint_forked(ok ? 0 : -1);
+}
+
 void wrap_up() {
     VerilatedVpi::callCbs(cbEndOfSimulation);
 
@@ -60,14 +463,29 @@ void wrap_up() {
     if (tfp) {
         delete tfp;
         tfp = nullptr;
+#if !VM_TRACE_FST
+        delete trace_writer;  // Writes out everything queued
+        trace_writer = nullptr;
+#endif
     }
 #endif
 
+    vlog_profile_write(
+        fork_index ? fork_file_name("sim_profile.json", fork_index).c_str()
+                   : "sim_profile.json");
+
     // VM_COVERAGE is a define which is set if Verilator is
     // instructed to collect coverage (when compiling the simulation)
 #if VM_COVERAGE
-    VerilatedCov::write();  // Uses +verilator+coverage+file+<filename>,
-                            // defaults to coverage.dat
+    if (fork_index) {
+        VerilatedCov::write(
+            fork_file_name(Verilated::threadContextp()->coverageFilename(),
+                           fork_index)
+                .c_str());
+    } else {
+        VerilatedCov::write();  // Uses +verilator+coverage+file+<filename>,
+                                // defaults to coverage.dat
+    }
 #endif
 }
 
@@ -109,7 +527,7 @@ int main(int argc, char **argv) {
                 "\n"
                 "options:\n"
                 "  --trace       Enable tracing (VCD or FST)\n"
-                "  --trace-flush Flush trace at each time step (slow)\n"
+                "  --trace-flush Flush trace at each time step\n"
                 "  --trace-file  Specify the trace file name (%s by "
                 "default)\n",
                 basename(argv[0]), traceFile);
@@ -131,47 +549,80 @@ int main(int argc, char **argv) {
 #if VM_TRACE
     Verilated::traceEverOn(true);
     if (traceOn) {
+#if VM_TRACE_FST
         tfp = new verilated_trace_t;
+#else
+        trace_writer = new TraceWriter;
+        tfp = new verilated_trace_t(trace_writer);
+#endif
         top->trace(tfp, 99);
         tfp->open(traceFile);
+        trace_name = traceFile;
     }
 #endif
 
     vlog_startup_routines_bootstrap();
+    vlog_checkpoint_enable();
+    profile_init();
+#if VM_TRACE
+    if (tfp) {
+        vlog_trace_control_enable(!VM_TRACE_FST);
+    }
+#endif
     Verilated::addExitCb([](void *) { wrap_up(); }, nullptr);
     VerilatedVpi::callCbs(cbStartOfSimulation);
     settle_value_callbacks();
 
     while (!Verilated::gotFinish()) {
+        profile_count(profile.time_steps);
         do {
             // We must evaluate whole design until we process all 'events' for
             // this time step
             do {
-                top->eval_step();
-                VerilatedVpi::clearEvalNeeded();
-                VerilatedVpi::doInertialPuts();
+                profile_count(profile.eval_iterations);
+                {
+                    ProfileScope scope(profile.eval_ticks);
+                    top->eval_step();
+                    VerilatedVpi::clearEvalNeeded();
+                    VerilatedVpi::doInertialPuts();
+                }
                 settle_value_callbacks();
             } while (VerilatedVpi::evalNeeded());
 
             // Run ReadWrite callback as we are done processing this eval step
-            VerilatedVpi::callCbs(cbReadWriteSynch);
-            VerilatedVpi::doInertialPuts();
+            {
+                ProfileScope scope(profile.read_write_ticks);
+                VerilatedVpi::callCbs(cbReadWriteSynch);
+                VerilatedVpi::doInertialPuts();
+            }
             settle_value_callbacks();
         } while (VerilatedVpi::evalNeeded());
 
-        top->eval_end_step();
+        {
+            ProfileScope scope(profile.eval_ticks);
+            top->eval_end_step();
+        }
 
         // Call ReadOnly callbacks
-        VerilatedVpi::callCbs(cbReadOnlySynch);
+        {
+            ProfileScope scope(profile.read_only_ticks);
+            VerilatedVpi::callCbs(cbReadOnlySynch);
+        }
 
 #if VM_TRACE
         if (tfp) {
-            tfp->dump(main_time);
-            if (traceFlush) {
-                tfp->flush();
-            }
+            ProfileScope scope(profile.trace_ticks);
+            dump_trace(traceFlush);
         }
 #endif
+
+        // Fork any simulations requested from this time step, now that it is
+        // complete
+        int n_children = vlog_checkpoint_take_request();
+        if (n_children > 0) {
+            fork_checkpoint(traceFile, n_children);
+        }
+
         // cocotb controls the clock inputs using cbAfterDelay so
         // skip ahead to the next registered callback
         const vluint64_t NO_TOP_EVENTS_PENDING = static_cast<vluint64_t>(~0ULL);
@@ -191,13 +642,19 @@ int main(int argc, char **argv) {
         // Call registered NextSimTime
         // It should be called in simulation cycle before everything else
         // but not on first cycle
-        VerilatedVpi::callCbs(cbNextSimTime);
+        {
+            ProfileScope scope(profile.next_sim_time_ticks);
+            VerilatedVpi::callCbs(cbNextSimTime);
+        }
         settle_value_callbacks();
 
         // Call registered timed callbacks (e.g. clock timer)
         // These are called at the beginning of the time step
         // before the iterative regions (IEEE 1800-2012 4.4.1)
-        VerilatedVpi::callTimedCbs();
+        {
+            ProfileScope scope(profile.timed_ticks);
+            VerilatedVpi::callTimedCbs();
+        }
         settle_value_callbacks();
     }
 
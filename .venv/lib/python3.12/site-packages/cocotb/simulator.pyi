@@ -5,7 +5,7 @@
 # generated with mypy's stubgen script
 
 from logging import Logger
-from typing import Any, Callable
+from typing import Any, Callable, Sequence
 
 from cocotb.handle import GPIDiscovery
 
@@ -51,6 +51,7 @@ class gpi_sim_hdl:
     def get_definition_file(self) -> str: ...
     def get_definition_name(self) -> str: ...
     def get_handle_by_index(self, index: int) -> gpi_sim_hdl | None: ...
+    def discover_scope(self, depth: int = -1, /) -> int: ...
     def get_handle_by_name(
         self, name: str, discovery_method: GPIDiscovery | None = GPIDiscovery.AUTO
     ) -> gpi_sim_hdl | None: ...
@@ -62,6 +63,7 @@ class gpi_sim_hdl:
     def get_signal_val_long(self) -> int: ...
     def get_signal_val_real(self) -> float: ...
     def get_signal_val_str(self) -> bytes: ...
+    def get_signal_val_vector(self, buffer: bytearray | memoryview) -> int: ...
     def get_type(self) -> int: ...
     def get_type_string(self) -> str: ...
     def iterate(self, mode: int) -> gpi_iterator_hdl: ...
@@ -69,11 +71,17 @@ class gpi_sim_hdl:
     def set_signal_val_int(self, action: int, value: int) -> None: ...
     def set_signal_val_real(self, action: int, value: float) -> None: ...
     def set_signal_val_str(self, action: int, value: bytes) -> None: ...
+    def set_signal_val_vector(
+        self, action: int, value: bytes | bytearray | memoryview
+    ) -> None: ...
     def __eq__(self, other: object) -> bool: ...
     def __ne__(self, other: object) -> bool: ...
     def __hash__(self) -> int: ...
 
+def get_checkpoint_index() -> int: ...
 def get_precision() -> int: ...
+def get_profile() -> dict[str, int]: ...
+def get_profile_tick_rate() -> float: ...
 def get_root_handle(name: str | None) -> gpi_sim_hdl | None: ...
 def get_sim_time() -> tuple[int, int]: ...
 def get_simulator_product() -> str: ...
@@ -81,6 +89,9 @@ def get_simulator_version() -> str: ...
 def is_running() -> bool: ...
 def set_gpi_log_level(level: int) -> None: ...
 def package_iterate() -> gpi_iterator_hdl: ...
+def register_persistent_value_change_callback(
+    signal: gpi_sim_hdl, func: Callable[..., Any], edge: int, *args: Any
+) -> gpi_cb_hdl | None: ...
 def register_nextstep_callback(func: Callable[..., Any], *args: Any) -> gpi_cb_hdl: ...
 def register_readonly_callback(func: Callable[..., Any], *args: Any) -> gpi_cb_hdl: ...
 def register_rwsynch_callback(func: Callable[..., Any], *args: Any) -> gpi_cb_hdl: ...
@@ -90,7 +101,12 @@ def register_timed_callback(
 def register_value_change_callback(
     signal: gpi_sim_hdl, func: Callable[..., Any], edge: int, *args: Any
 ) -> gpi_cb_hdl: ...
+def request_checkpoint(n_children: int) -> None: ...
 def stop_simulator() -> None: ...
+def trace_save_ring() -> None: ...
+def trace_set_ring(steps: int) -> None: ...
+def trace_set_trigger(signals: Sequence[gpi_sim_hdl], values: Sequence[int]) -> None: ...
+def trace_set_window(start: int, stop: int) -> None: ...
 
 class cpp_clock:
     def __init__(self, signal: gpi_sim_hdl) -> None: ...
@@ -100,6 +116,28 @@ class cpp_clock:
     def stop(self) -> None: ...
 
 def clock_create(hdl: gpi_sim_hdl) -> cpp_clock: ...
+
+class GpiPlayer:
+    def load(self, stimulus: bytes | bytearray | memoryview) -> None: ...
+    def watch(self, index: int, mask: int, value: int) -> None: ...
+    def start(self, set_action: int, func: Callable[..., Any], *args: Any) -> None: ...
+    def stop(self) -> None: ...
+    def cycles(self) -> int: ...
+    def captured(self) -> bytes: ...
+
+def player_create(
+    clock: gpi_sim_hdl, drive: Sequence[gpi_sim_hdl], capture: Sequence[gpi_sim_hdl]
+) -> GpiPlayer: ...
+class GpiMonitor:
+    def start(self, on_violation: Callable[[str], Any]) -> None: ...
+    def stop(self) -> None: ...
+    def stats(self) -> dict[str, Any]: ...
+
+def monitor_create(
+    clock: gpi_sim_hdl,
+    upstream: Sequence[gpi_sim_hdl],
+    downstream: Sequence[gpi_sim_hdl],
+) -> GpiMonitor: ...
 def initialize_logger(
     log_func: Callable[[Logger, int, str, int, str, str], None],
     get_logger: Callable[[str], Logger],
@@ -0,0 +1,87 @@
+# Copyright cocotb contributors
+# Licensed under the Revised BSD License, see LICENSE for details.
+# SPDX-License-Identifier: BSD-3-Clause
+
+"""Controlling which parts of the simulation are traced."""
+
+from __future__ import annotations
+
+from cocotb import simulator
+from cocotb.handle import ValueObjectBase
+from cocotb.simtime import TimeUnit
+from cocotb.utils import get_sim_steps
+
+__all__ = ("keep_last", "save_trace_ring", "trace_between", "trace_while")
+
+
+def trace_between(
+    start: float, stop: float | None = None, unit: TimeUnit = "step"
+) -> None:
+    """Only trace the simulation from *start* up to, but not including, *stop*.
+
+    Args:
+        start: The time to start tracing at.
+        stop: The time to stop tracing at, or ``None`` to trace until the end.
+        unit: The unit of *start* and *stop*.
+
+    Raises:
+        RuntimeError: If the simulator does not support trace control.
+    """
+    start_steps = get_sim_steps(start, unit, round_mode="floor")
+    if stop is None:
+        stop_steps = (1 << 64) - 1
+    else:
+        stop_steps = get_sim_steps(stop, unit, round_mode="ceil")
+    simulator.trace_set_window(start_steps, stop_steps)
+
+
+def trace_while(*conditions: tuple[ValueObjectBase, int]) -> None:
+    """Only trace the time steps at the end of which every signal has its value.
+
+    For example, to only trace backpressure:
+
+    .. code-block:: python
+
+        trace_while((dut.valid_out, 1), (dut.ready_out, 0))
+
+    Call it with no conditions to trace every time step again.
+
+    Raises:
+        RuntimeError: If the simulator does not support trace control.
+    """
+    simulator.trace_set_trigger(
+        [signal._handle for signal, _ in conditions],
+        [value for _, value in conditions],
+    )
+
+
+def keep_last(steps: int) -> None:
+    """Keep the trace in memory from now on, holding at least the last *steps* traced time steps.
+
+    Nothing more is written to the trace file.
+    The time steps are held in two segments of up to *steps* each,
+    dropping the older segment when the newer one is full,
+    so up to ``2 * steps`` are held.
+    A time step is not a clock cycle: every time the simulation
+    stops, for a clock edge or a :class:`~cocotb.triggers.Timer`, is one.
+    Call :func:`save_trace_ring` to write the time steps held to a new file,
+    named like ``dump.ring1.vcd``, for example when a check fails.
+
+    Call ``keep_last(0)`` to go back to writing the trace file,
+    dropping the time steps held and not saved.
+
+    Only the Verilator harness supports this, when writing a VCD.
+
+    Raises:
+        RuntimeError: If the simulator does not support a trace ring.
+    """
+    simulator.trace_set_ring(steps)
+
+
+def save_trace_ring() -> None:
+    """Write the time steps held by :func:`keep_last` to a new file at the end of the current time step.
+
+    Raises:
+        RuntimeError: If :func:`keep_last` was not called.
+    """
+    simulator.trace_save_ring()
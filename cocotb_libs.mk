@@ -0,0 +1,61 @@
+# Build the cocotb libraries used with Verilator from the sources in the
+# virtual environment.
+#
+# libgpi, the VPI layer for Verilator and the cocotb.simulator extension are
+# extended in place under .venv/lib/python3.12/site-packages/cocotb/share, so
+# the binaries installed with the cocotb wheel are out of date. tb/Makefile
+# includes this file so they are rebuilt, and the harness with them, whenever
+# one of their sources changes. To build them on their own, with the virtual
+# environment active:
+#
+#   make libs
+#
+# Only the Verilator VPI layer is rebuilt; the libraries for other simulators
+# in cocotb/libs are the prebuilt ones and don't match the rebuilt libgpi.
+
+PYTHON_BIN ?= python3
+
+COCOTB_SHARE := $(shell $(PYTHON_BIN) -m cocotb_tools.config --share)
+COCOTB_LIB_DIR := $(shell $(PYTHON_BIN) -m cocotb_tools.config --lib-dir)
+COCOTB_PY_INCLUDE := $(shell $(PYTHON_BIN) -c "import sysconfig; print(sysconfig.get_paths()['include'])")
+COCOTB_EXT_SUFFIX := $(shell $(PYTHON_BIN) -c "import sysconfig; print(sysconfig.get_config_var('EXT_SUFFIX'))")
+
+COCOTB_LIBGPI := $(COCOTB_LIB_DIR)/libgpi.so
+COCOTB_LIBVPI := $(COCOTB_LIB_DIR)/libcocotbvpi_verilator.so
+COCOTB_SIMULATOR := $(COCOTB_SHARE)/../simulator$(COCOTB_EXT_SUFFIX)
+COCOTB_LIBS := $(COCOTB_LIBGPI) $(COCOTB_LIBVPI) $(COCOTB_SIMULATOR)
+
+# The same flags the cocotb wheel builds with
+COCOTB_CXXFLAGS := -std=c++11 -O2 -g -fPIC -pthread \
+	-fvisibility=hidden -fvisibility-inlines-hidden \
+	-I$(COCOTB_SHARE)/include -I$(COCOTB_SHARE)/..
+
+COCOTB_HEADERS := $(wildcard $(COCOTB_SHARE)/include/*.h \
+	$(COCOTB_SHARE)/lib/*.hpp $(COCOTB_SHARE)/lib/gpi/*.hpp \
+	$(COCOTB_SHARE)/lib/gpi/vpi/*.hpp $(COCOTB_SHARE)/lib/pygpi/*.hpp)
+
+COCOTB_LIBGPI_SRCS := $(addprefix $(COCOTB_SHARE)/lib/gpi/, \
+	GpiCbHdl.cpp GpiCommon.cpp dynload.cpp logging.cpp)
+COCOTB_LIBVPI_SRCS := $(addprefix $(COCOTB_SHARE)/lib/gpi/vpi/, \
+	VpiCbHdl.cpp VpiImpl.cpp VpiIterator.cpp VpiObj.cpp VpiSignal.cpp)
+COCOTB_SIMULATOR_SRCS := $(addprefix $(COCOTB_SHARE)/lib/pygpi/, \
+	bind.cpp embed.cpp logging.cpp)
+
+# Link to a temporary file and move it in place, so a simulation still running
+# with the old library isn't pulled from under it
+$(COCOTB_LIBGPI): $(COCOTB_LIBGPI_SRCS) $(COCOTB_HEADERS)
+	$(CXX) $(COCOTB_CXXFLAGS) -DGPI_EXPORTS -shared -o $@.tmp \
+		$(COCOTB_LIBGPI_SRCS) -Wl,-rpath,'$$ORIGIN' -ldl
+	mv -f $@.tmp $@
+
+$(COCOTB_LIBVPI): $(COCOTB_LIBVPI_SRCS) $(COCOTB_HEADERS) $(COCOTB_LIBGPI)
+	$(CXX) $(COCOTB_CXXFLAGS) -DCOCOTBVPI_EXPORTS -DVERILATOR -shared \
+		-o $@.tmp $(COCOTB_LIBVPI_SRCS) -L$(COCOTB_LIB_DIR) -lgpi \
+		-Wl,-rpath,'$$ORIGIN'
+	mv -f $@.tmp $@
+
+$(COCOTB_SIMULATOR): $(COCOTB_SIMULATOR_SRCS) $(COCOTB_HEADERS) $(COCOTB_LIBGPI)
+	$(CXX) $(COCOTB_CXXFLAGS) -DPYGPI_EXPORTS -I$(COCOTB_PY_INCLUDE) -shared \
+		-o $@.tmp $(COCOTB_SIMULATOR_SRCS) -L$(COCOTB_LIB_DIR) -lgpi \
+		-Wl,-rpath,'$$ORIGIN/libs'
+	mv -f $@.tmp $@
@@ -0,0 +1,71 @@
+// DEPTH-stage valid/ready pipeline
+// Each stage is picked with its bit in the SKID and BYPASS masks:
+// - default: valid_ready, 1 cycle of latency, combinational ready
+// - SKID:    valid_ready_skid, 1 cycle of latency, registered ready
+// - BYPASS:  wires straight through, 0 cycles of latency (wins over SKID)
+module valid_ready_pipeline #(
+    parameter int WIDTH = 8,
+    parameter int DEPTH = 4,
+    parameter logic [DEPTH-1:0] SKID   = '0,
+    parameter logic [DEPTH-1:0] BYPASS = '0
+) (
+    input  wire             clk,
+    input  wire             rst,
+    // Input (producer side)
+    input  wire             valid_in,
+    input  wire [WIDTH-1:0] data_in,
+    output logic            ready_in,
+    // Output (consumer side)
+    output logic            valid_out,
+    output logic [WIDTH-1:0] data_out,
+    input  wire             ready_out
+);
+    // Handshake between stage i-1 and stage i is valid[i]/data[i]/ready[i];
+    // index 0 is the pipeline input and index DEPTH the pipeline output.
+    // ready (and valid/data through bypassed stages) chains through elements
+    // of the same array, so let Verilator schedule them separately
+    logic             valid [DEPTH+1] /* verilator split_var */;
+    logic [WIDTH-1:0] data  [DEPTH+1] /* verilator split_var */;
+    logic             ready [DEPTH+1] /* verilator split_var */;
+
+    assign valid[0]     = valid_in;
+    assign data[0]      = data_in;
+    assign ready_in     = ready[0];
+    assign valid_out    = valid[DEPTH];
+    assign data_out     = data[DEPTH];
+    assign ready[DEPTH] = ready_out;
+
+    for (genvar i = 0; i < DEPTH; i++) begin : g_stage
+        if (BYPASS[i]) begin : g_bypass
+            assign valid[i+1] = valid[i];
+            assign data[i+1]  = data[i];
+            assign ready[i]   = ready[i+1];
+        end else if (SKID[i]) begin : g_skid
+            valid_ready_skid #(
+                .WIDTH(WIDTH)
+            ) u_stage (
+                .clk      (clk),
+                .rst      (rst),
+                .valid_in (valid[i]),
+                .data_in  (data[i]),
+                .ready_in (ready[i]),
+                .valid_out(valid[i+1]),
+                .data_out (data[i+1]),
+                .ready_out(ready[i+1])
+            );
+        end else begin : g_reg
+            valid_ready #(
+                .WIDTH(WIDTH)
+            ) u_stage (
+                .clk      (clk),
+                .rst      (rst),
+                .valid_in (valid[i]),
+                .data_in  (data[i]),
+                .ready_in (ready[i]),
+                .valid_out(valid[i+1]),
+                .data_out (data[i+1]),
+                .ready_out(ready[i+1])
+            );
+        end
+    end
+endmodule
@@ -0,0 +1,60 @@
+// Single-stage valid/ready pipeline with a registered ready
+// A 2-entry skid buffer keeps full throughput without a combinational path
+// from ready_out to ready_in
+module valid_ready_skid #(
+    parameter int WIDTH = 8
+) (
+    input  wire             clk,
+    input  wire             rst,
+    // Input (producer side)
+    input  wire             valid_in,
+    input  wire [WIDTH-1:0] data_in,
+    output logic            ready_in,
+    // Output (consumer side)
+    output logic            valid_out,
+    output logic [WIDTH-1:0] data_out,
+    input  wire             ready_out
+);
+    // data_reg/valid_reg is the output register, as in valid_ready
+    // skid_reg/skid_valid catches the one beat accepted in the cycle the
+    // output stalls, because ready_in only drops a cycle later
+    logic [WIDTH-1:0] data_reg;
+    logic             valid_reg;
+    logic [WIDTH-1:0] skid_reg;
+    logic             skid_valid;
+    // We can accept the data as long as the skid entry is free (registered)
+    assign ready_in = ~skid_valid;
+    // Output signals reflect internal state
+    assign valid_out = valid_reg;
+    assign data_out  = data_reg;
+    always_ff @(posedge clk or posedge rst) begin
+        if (rst) begin
+            // Reset clears both entries
+            valid_reg  <= 1'b0;
+            skid_valid <= 1'b0;
+        end else begin
+            // Case 1: The output register is empty or being read
+            if (~valid_reg || ready_out) begin
+                if (skid_valid) begin
+                    // Refill from the skid entry; ready_in is low, so
+                    // nothing new comes in this cycle
+                    data_reg   <= skid_reg;
+                    valid_reg  <= 1'b1;
+                    skid_valid <= 1'b0;
+                end else begin
+                    // Pass new data straight to the output register
+                    if (valid_in) begin
+                        data_reg <= data_in;
+                    end
+                    valid_reg <= valid_in;
+                end
+            end
+            // Case 2: The output stalls while we still accept data
+            else if (valid_in && ready_in) begin
+                skid_reg   <= data_in;
+                skid_valid <= 1'b1;
+            end
+            // Else: hold state
+        end
+    end
+endmodule
@@ -0,0 +1,46 @@
+import logging
+import os
+import sys
+import tempfile
+
+import cocotb
+from cocotb.triggers import Timer
+
+
+@cocotb.test(skip=os.environ.get("GPI_LOG_ASYNC", "0") == "0")
+async def async_log_test(dut):
+    """Check the order of queued GPI messages, run by `make async_log` with GPI_LOG_ASYNC=1 and GPI_LOG_LEVEL=DEBUG."""
+    await Timer(1, units="ns")
+
+    # The writer thread prints queued messages to fd 1. Send it to a file, and
+    # GPI warnings there too, unbuffered, so the file has them in the order
+    # they were written.
+    gpi_log = logging.getLogger("gpi")
+    with tempfile.TemporaryFile() as capture:
+        sys.stdout.flush()
+        saved = os.dup(1)
+        os.dup2(capture.fileno(), 1)
+        handler = logging.StreamHandler(open(1, "w", buffering=1, closefd=False))
+        gpi_log.addHandler(handler)
+        try:
+            # Logs "Checking if index 99 native ..." at DEBUG, which is
+            # queued, then "Failed to find a handle at index 99 ..." at
+            # WARNING, which must come after it
+            assert dut.data_in._handle.get_handle_by_index(99) is None
+        finally:
+            gpi_log.removeHandler(handler)
+            handler.stream.close()
+            os.dup2(saved, 1)
+            os.close(saved)
+
+        capture.seek(0)
+        lines = capture.read().decode().splitlines()
+
+    debug = [i for i, line in enumerate(lines) if "Checking if index 99 native" in line]
+    warning = [i for i, line in enumerate(lines) if "Failed to find a handle at index 99" in line]
+    assert debug and warning, lines
+    assert debug[0] < warning[0], lines
+
+    # Only logs at DEBUG, so it is still queued at the end of the simulation
+    # unless the ring is flushed at exit; `make async_log` checks the output
+    assert dut._handle.get_handle_by_name("async_log_last") is None
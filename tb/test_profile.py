@@ -0,0 +1,42 @@
+import os
+
+import cocotb
+import cocotb.simulator
+from cocotb.clock import Clock
+from cocotb.triggers import RisingEdge, Timer
+
+
+@cocotb.test(skip=os.environ.get("GPI_PROFILE", "0") == "0")
+async def profile_test(dut):
+    """Check the simulation profile counters, run by `make profile` with GPI_PROFILE=1."""
+
+    # Start clock
+    cocotb.start_soon(Clock(dut.clk, 10, units="ns").start())
+
+    # Give the harness, VPI and Python callbacks something to count
+    for _ in range(10):
+        await RisingEdge(dut.clk)
+    await Timer(3, units="ns")
+
+    assert cocotb.simulator.get_profile_tick_rate() > 0
+
+    profile = cocotb.simulator.get_profile()
+    for name in (
+        "harness.time_steps",
+        "harness.eval.iterations",
+        "harness.eval.ticks",
+        "harness.timed.ticks",
+        "vpi.callbacks",
+        "vpi.callbacks.cbValueChange",
+        "vpi.callbacks.cbAfterDelay",
+        "pygpi.callbacks",
+        "pygpi.callbacks.ticks",
+    ):
+        assert profile.get(name, 0) > 0, f"{name} not counted: {profile}"
+
+    # Every VPI callback is counted once in total and once by its reason
+    by_reason = sum(
+        value for name, value in profile.items()
+        if name.startswith("vpi.callbacks.")
+    )
+    assert by_reason == profile["vpi.callbacks"], profile
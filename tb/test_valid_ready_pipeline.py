@@ -0,0 +1,167 @@
+import os
+import random
+import re
+import time
+from collections import deque
+
+import cocotb
+from cocotb import simulator
+from cocotb.triggers import RisingEdge, ReadOnly
+from cocotb.clock import Clock
+
+
+# Pipeline configuration, passed in by tb/Makefile
+DEPTH = int(os.getenv("DEPTH", "4"))
+SKID = int(os.getenv("SKID", "0"), 0)
+BYPASS = int(os.getenv("BYPASS", "0"), 0)
+LATENCY = DEPTH - bin(BYPASS & ((1 << DEPTH) - 1)).count("1")
+
+
+async def reset(dut):
+    cocotb.start_soon(Clock(dut.clk, 10, units="ns").start())
+
+    dut.rst.value = 1
+    dut.valid_in.value = 0
+    dut.data_in.value = 0
+    dut.ready_out.value = 0
+    await RisingEdge(dut.clk)
+
+    dut.rst.value = 0
+    await RisingEdge(dut.clk)
+
+
+async def run_traffic(dut, cycles, valid_prob, ready_prob):
+    """Stream sequence numbers through the pipeline and check them out in order.
+
+    Returns (beats out, cycles with ready_out high, per-beat latencies).
+    """
+    mask = (1 << len(dut.data_in)) - 1
+    seq = 0
+    in_flight = deque()  # (data, cycle accepted)
+    beats = 0
+    ready_cycles = 0
+    latencies = []
+
+    for cycle in range(cycles):
+        valid_in = int(random.random() < valid_prob)
+        ready_out = int(random.random() < ready_prob)
+        dut.valid_in.value = valid_in
+        dut.data_in.value = seq & mask
+        dut.ready_out.value = ready_out
+        await ReadOnly()
+
+        # Handshakes complete on the coming edge
+        if valid_in and dut.ready_in.value:
+            in_flight.append((seq & mask, cycle))
+            seq += 1
+        if dut.valid_out.value and ready_out:
+            assert in_flight, f"Data out of an empty pipeline at cycle {cycle}"
+            data, accepted = in_flight.popleft()
+            assert int(dut.data_out.value) == data, f"Data lost or reordered at cycle {cycle}"
+            latencies.append(cycle - accepted)
+            beats += 1
+        ready_cycles += ready_out
+        await RisingEdge(dut.clk)
+
+    return beats, ready_cycles, latencies
+
+
+def report(dut, name, cycles, beats, latencies):
+    dut._log.info(
+        "DEPTH=%d SKID=%#x BYPASS=%#x %s: throughput %.3f beats/cycle, "
+        "latency min %d avg %.2f max %d cycles",
+        DEPTH, SKID, BYPASS, name, beats / cycles,
+        min(latencies), sum(latencies) / len(latencies), max(latencies),
+    )
+
+
+@cocotb.test()
+async def pipeline_continuous_test(dut):
+    await reset(dut)
+
+    cycles = 1000
+    beats, _, latencies = await run_traffic(dut, cycles, 1.0, 1.0)
+    report(dut, "continuous flow", cycles, beats, latencies)
+
+    # One beat per cycle once the pipeline has filled, whatever the stage mix
+    assert beats == cycles - LATENCY
+    assert set(latencies) == {LATENCY}
+
+
+@cocotb.test()
+async def pipeline_backpressure_test(dut):
+    await reset(dut)
+
+    cycles = 5000
+    beats, ready_cycles, latencies = await run_traffic(dut, cycles, 1.0, 0.5)
+    report(dut, "random backpressure", cycles, beats, latencies)
+
+    # With the input always valid, every cycle downstream is ready should
+    # carry a beat: skid stages must not lose throughput to their
+    # registered ready
+    assert beats >= ready_cycles - LATENCY
+    assert min(latencies) >= LATENCY
+
+
+@cocotb.test()
+async def pipeline_random_test(dut):
+    await reset(dut)
+
+    cycles = 5000
+    beats, _, latencies = await run_traffic(dut, cycles, 0.5, 0.5)
+    report(dut, "random traffic", cycles, beats, latencies)
+
+    assert min(latencies) >= LATENCY
+
+
+def walk(handle, objects):
+    """Collect (parent, child) for every object below *handle* from the simulator's iterators."""
+    for child in handle.iterate(simulator.OBJECTS):
+        objects.append((handle, child))
+        if child.get_type() in (simulator.MODULE, simulator.GENARRAY, simulator.STRUCTURE):
+            walk(child, objects)
+
+
+@cocotb.test()
+async def pipeline_discover_scope_test(dut):
+    root = dut._handle
+
+    objects = []
+    walk(root, objects)
+
+    # Look every object up under its name, or its index for the stages of
+    # the g_stage generate array, through the simulator before anything is
+    # discovered
+    def look_up(parent, child):
+        name = child.get_name_string()
+        if parent.get_type() == simulator.GENARRAY:
+            index = int(re.search(r"\[(\d+)\]$", name).group(1))
+            return name, parent.get_handle_by_index(index)
+        return name, parent.get_handle_by_name(name)
+
+    start = time.perf_counter()
+    expected = [look_up(parent, child) for parent, child in objects]
+    searched = time.perf_counter() - start
+    assert all(hdl is not None for _, hdl in expected)
+    stages = sum(1 for parent, _ in objects if parent.get_type() == simulator.GENARRAY)
+    assert stages == DEPTH
+
+    start = time.perf_counter()
+    count = root.discover_scope()
+    discovered = time.perf_counter() - start
+    assert count == len(objects)
+
+    # Looking them up again now finds what discovery stored, which must be
+    # what the simulator found
+    start = time.perf_counter()
+    found = [look_up(parent, child) for parent, child in objects]
+    looked_up = time.perf_counter() - start
+    for (name, before), (_, after) in zip(expected, found):
+        assert after == before, name
+
+    dut._log.info(
+        "Looked up %d objects in %.0f us, discovered them in %.0f us, "
+        "looked them all up again in %.0f us",
+        count, searched * 1e6, discovered * 1e6, looked_up * 1e6,
+    )
+